@@ -0,0 +1,16 @@
+#ifndef AI_H
+#define AI_H
+
+#include "rules.h"
+
+// 1局面分の青AI（空白マスの少なさ→スコアの順で列を選ぶ）
+int getBestColumnForBlue(const GameState* state);
+
+// 同じ貪欲AIを手番側（currentPlayer）から見て使う（赤の手番でも赤がリードしているときだけ最後の列で終わらせる）
+int getGreedyColumn(const GameState* state);
+
+// 複数局面をまとめて評価し、各局面の最善列を outColumns に書き込む
+// 列の評価表を共有し、件数が多いときは共有スレッドプールで分担する
+void getBestColumnsForBlue(const GameState* states, int count, int* outColumns);
+
+#endif // AI_H
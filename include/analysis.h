@@ -0,0 +1,24 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "rules.h"
+
+// バックグラウンド解析の結果（手番側がその列を選んだときの勝率）
+typedef struct {
+    uint32_t revision;           // 解析した局面の GameState::revision
+    Player player;               // 勝率の視点（解析時の手番）
+    int samples[BOARD_SIZE];     // 各列のプレイアウト数（0なら選択不可または未解析）
+    float winRate[BOARD_SIZE];   // 勝ち=1、引き分け=0.5 の平均
+} AnalysisSnapshot;
+
+// 解析スレッドの開始・停止
+void startAnalysis();
+void stopAnalysis();
+
+// 解析対象の局面を渡す。revision が前回と同じなら何もしない（結果を再利用）
+void requestAnalysis(const GameState* state);
+
+// 最新の結果を取得する。解析スレッドが結果を書き込み中なら待たずに false を返す
+bool getAnalysisSnapshot(AnalysisSnapshot* snapshot);
+
+#endif // ANALYSIS_H
@@ -0,0 +1,36 @@
+#ifndef CONTROLLER_H
+#define CONTROLLER_H
+
+#include "rules.h"
+#include "search.h"
+
+// 各陣営の手の決め方
+enum ControllerKind {
+    CONTROLLER_HUMAN = 0,     // マウス入力
+    CONTROLLER_GREEDY = 1,    // 貪欲AI（getGreedyColumn、手番側から見る）
+    CONTROLLER_SEARCH = 2,    // 期待値探索AI
+    CONTROLLER_RANDOM = 3,    // 選べる列からランダム
+    CONTROLLER_SCRIPTED = 4   // 決められた列の順に打つ
+};
+
+#define CONTROLLER_MAX_SCRIPT 64
+
+typedef struct {
+    ControllerKind kind;
+    SearchConfig search;                  // CONTROLLER_SEARCH 用
+    int script[CONTROLLER_MAX_SCRIPT];    // CONTROLLER_SCRIPTED 用（自分の n 手目に script[n] を打つ）
+    int scriptLength;
+} Controller;
+
+// "human", "greedy", "search", "search:4"（探索手数）, "random", "script:0,3,5" を解釈する
+bool parseController(const char* text, Controller* controller);
+
+// 表示用の名前（"search:3" など）を buffer に書く
+void formatController(const Controller* controller, char* buffer, int bufferSize);
+
+// 手番側の列を決める。人間の場合と選べる列がない場合は -1
+// スクリプトが尽きたり反則になる場合は貪欲AIで代わりに打つ
+// stats（NULL可）には探索AIの場合のみこの手の統計を書き込む
+int chooseControllerMove(const Controller* controller, GameState* state, SearchStats* stats);
+
+#endif // CONTROLLER_H
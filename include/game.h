@@ -2,58 +2,18 @@
 #define GAME_H
 
 #include <stdbool.h>
+#include <stdio.h>
 #include <GLFW/glfw3.h>
 
+#include "rules.h"
+#include "ai.h"
+#include "controller.h"
+#include "game_record.h"
+
 // ゲーム定数
-#define BOARD_SIZE 6
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 600
 
-// マスの状態
-enum CellValue {
-    INVALID = 0,
-    PLUS_ONE = 1,
-    MINUS_ONE = -1,
-    PLUS_TWO = 2
-};
-
-// プレイヤー
-enum Player {
-    PLAYER_RED = 1,
-    PLAYER_BLUE = 2,
-    PLAYER_TIE = 0  // 引き分け
-};
-
-// 列の状態
-enum ColumnState {
-    EMPTY = 0,
-    PAINTED_RED = 1,
-    PAINTED_BLUE = 2
-};
-
-// 演出状態
-enum EffectState {
-    NO_EFFECT = 0,
-    EFFECT_WAITING = 1,    // 0.5秒待機
-    EFFECT_DARKENING = 2   // 暗転演出
-};
-
-// ゲーム状態
-typedef struct {
-    CellValue board[BOARD_SIZE][BOARD_SIZE];  // 6x6のボード
-    ColumnState columnStates[BOARD_SIZE];     // 各列の状態
-    Player currentPlayer;                     // 現在のプレイヤー
-    int redScore;                             // 赤のスコア
-    int blueScore;                            // 青のスコア
-    bool gameOver;                            // ゲーム終了フラグ
-    int paintedColumns;                       // 塗られた列の数
-    bool waitingForAI;                        // AI待機中フラグ
-    double aiStartTime;                       // AI思考開始時間
-    EffectState effectState;                  // 演出状態
-    double effectStartTime;                   // 演出開始時間
-    bool plusTwoTriggered;                    // +2変化が発生したかのフラグ
-} GameState;
-
 // ゲーム関数
 void initGame();
 void initBoard();
@@ -67,6 +27,18 @@ int countUnpaintedColumns();
 void triggerPlusTwoEffect();
 void applyPlusTwoChange();
 
+// 陣営ごとの操作（人間・AI・スクリプト）
+void setController(Player player, const Controller* controller);
+const Controller* getController(Player player);
+
+// 探索AIの統計（直前の手・現在の対局の合計）と、統計を書き出すCSVファイル（NULLで停止）
+const SearchStats* getLastMoveSearchStats();
+const SearchStats* getGameSearchStats(Player player);
+void setSearchStatsFile(FILE* fp);
+
+// 終局した対局の棋譜の書き込み先（NULLで停止）
+void setGameRecordWriter(GameRecordWriter* writer);
+
 // AI関数
 int getBestColumnForBlue();
 void makeAIMove();
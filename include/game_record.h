@@ -0,0 +1,90 @@
+#ifndef GAME_RECORD_H
+#define GAME_RECORD_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "rules.h"
+
+// 棋譜ファイル形式（リトルエンディアン）
+//   "PZGR" / version(u32) / ブロック容量(u32) / 予約(u32)
+//   以降ブロックの並び: { データ長(u32), 棋譜数(u32), CRC32(u32), データ }
+//   棋譜はブロックをまたがない。1局の符号化:
+//     flags(u8) / 手数(varint) / [シード(u64) | 初期盤面と再生成の3値列]
+//     / 選んだ列（6進で1バイトに3手） / [+2変化の手数(varint)] / 赤・青の得点(zigzag varint)
+//   シード付きの棋譜は再生成が乱数から決まるので盤面を持たない。シードのない棋譜は
+//   マスを 0=無効 1=プラス 2=-1 の3値にして、初期盤面36マス＋1手ごとの再生成6マスを1バイトに5個ずつ詰める
+#define GAME_RECORD_VERSION 1
+#define GAME_RECORD_MAX_PLIES 1024
+#define GAME_RECORD_MAX_BYTES 2048     // 1局の符号化の上限
+#define GAME_RECORD_BLOCK_SIZE 65536   // ブロックのデータ長の上限
+
+// 1局の棋譜
+typedef struct {
+    bool seeded;                  // true: seed から盤面と再生成を再現する
+    uint64_t seed;
+    uint8_t board[BOARD_SIZE][BOARD_SIZE];                 // 初期盤面の3値（シードなしのみ）
+    int plies;
+    uint8_t columns[GAME_RECORD_MAX_PLIES];                // 各手で選んだ列
+    uint8_t rerolls[GAME_RECORD_MAX_PLIES][BOARD_SIZE];    // 各手で再生成された列の3値（シードなしのみ）
+    int plusTwoPly;               // +2変化を反映した時点の手数（-1 = なし、シードなしのみ）
+    int redScore;
+    int blueScore;
+    Player winner;
+    bool truncated;               // 終局前に打ち切った
+} GameRecord;
+
+// 記録の開始（シードからの対局 / 現在の盤面から）
+void beginGameRecord(GameRecord* record, uint64_t seed);
+void beginGameRecordFromBoard(GameRecord* record, const GameState* state);
+// 手を打った直後の状態で1手を記録する（上限を超えたら false）
+bool addGameRecordMove(GameRecord* record, int col, const GameState* after);
+// 演出の後で+2変化を反映したときに呼ぶ（ウィンドウの対局用）
+void markGameRecordPlusTwo(GameRecord* record);
+void finishGameRecord(GameRecord* record, const GameState* state);
+
+// 棋譜を最初から打ち直して最終局面を state に返す。反則手や得点の不一致があれば false
+// visit（省略可）は各手を打つ前の局面（ply = 0..plies-1）と最終局面（ply = plies）で呼ばれる
+bool replayGameRecord(const GameRecord* record, GameState* state,
+                      const std::function<void(const GameState*, int)>& visit = nullptr);
+
+// 符号化した長さを返す（out は GAME_RECORD_MAX_BYTES 以上）
+int encodeGameRecord(const GameRecord* record, uint8_t* out);
+// 読んだ長さを返す（壊れていれば -1）
+int decodeGameRecord(const uint8_t* data, int size, GameRecord* record);
+
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t size);
+
+// バッファ付きの書き込み。writeGameRecord は複数スレッドから呼べる
+// （符号化はロックの外で行い、ブロックがいっぱいになったらまとめて書く）
+struct GameRecordWriter {
+    FILE* fp = NULL;
+    std::mutex mutex;
+    std::vector<uint8_t> block;
+    uint32_t blockRecords = 0;
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    bool ok = false;
+};
+
+bool openGameRecordWriter(GameRecordWriter* writer, const char* path);
+bool writeGameRecord(GameRecordWriter* writer, const GameRecord* record);
+bool closeGameRecordWriter(GameRecordWriter* writer);  // 残りのブロックを書いて閉じる
+
+// 読み込み。ブロックごとにCRCを確かめる
+struct GameRecordReader {
+    FILE* fp = NULL;
+    std::vector<uint8_t> block;
+    size_t offset = 0;
+    uint32_t remaining = 0;    // 現在のブロックに残っている棋譜数
+    uint64_t blocks = 0;
+};
+
+bool openGameRecordReader(GameRecordReader* reader, const char* path);
+// 1 = 読んだ、0 = 終わり、-1 = 壊れている
+int readGameRecord(GameRecordReader* reader, GameRecord* record);
+void closeGameRecordReader(GameRecordReader* reader);
+
+#endif // GAME_RECORD_H
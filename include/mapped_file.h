@@ -0,0 +1,20 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 読み取り専用のメモリマップ（POSIX は mmap、Windows は CreateFileMapping）
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+} MappedFile;
+
+bool mapFile(MappedFile* file, const char* path);
+void unmapFile(MappedFile* file);
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,51 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+#include <stdio.h>
+#include "controller.h"
+#include "game_record.h"
+
+// 塗り合いが続いて終わらない対局を打ち切る手数（打ち切り時は点数で勝敗を決める）
+#define MATCH_MAX_PLIES 400
+
+// 1局の結果
+typedef struct {
+    Player winner;
+    int redScore;
+    int blueScore;
+    int plies;
+    bool truncated;    // MATCH_MAX_PLIES で打ち切った
+    SearchStats redStats;   // 探索AIの統計（対局分の合計）
+    SearchStats blueStats;
+} MatchResult;
+
+// 複数局の集計
+typedef struct {
+    int games;
+    int redWins;
+    int blueWins;
+    int ties;
+    int truncated;
+    long long totalPlies;
+    long long redScoreSum;
+    long long blueScoreSum;
+    double seconds;
+    SearchStats redStats;
+    SearchStats blueStats;
+} MatchSummary;
+
+// 窓も待ち時間もなしで1局を最後まで進める（人間の陣営があれば false）
+// +2変化は演出を待たずにすぐ反映する。record（NULL可）には棋譜を残す
+bool playMatch(const Controller* red, const Controller* blue, uint64_t seed, MatchResult* result,
+               GameRecord* record = NULL);
+
+void addMatchResult(MatchSummary* summary, const MatchResult* result);
+void mergeMatchSummary(MatchSummary* into, const MatchSummary* from);
+
+// seed, seed+1, ... の games 局を共有スレッドプールで並列に対局する
+// statsFile（NULL可）には対局ごとの探索統計を1行ずつ、recordWriter（NULL可）には棋譜を書く
+bool runHeadlessGames(const Controller* red, const Controller* blue, int games, uint64_t seed,
+                      MatchSummary* summary, FILE* statsFile, GameRecordWriter* recordWriter = NULL);
+void printMatchSummary(const MatchSummary* summary, FILE* out);
+
+#endif // MATCH_H
@@ -0,0 +1,26 @@
+#ifndef OPENING_BOOK_H
+#define OPENING_BOOK_H
+
+#include <stdint.h>
+#include <vector>
+
+// 定跡ファイル形式（リトルエンディアン）
+//   "PZBK" / version(u32) / 件数(u32) / 作成時の探索手数(u32)
+//   件数分の { 局面ハッシュ(u64), 列キー(u16) } をハッシュ昇順で並べる
+#define OPENING_BOOK_VERSION 2
+
+typedef struct {
+    uint64_t hash;       // canonicalPositionHash
+    uint16_t columnKey;  // 選ぶべき列の列キー（列の位置に依存しない）
+} BookEntry;
+
+struct OpeningBook {
+    std::vector<BookEntry> entries;  // hash昇順
+    int depth = 0;                   // 各手を決めた探索手数（これより深い探索には使わない）
+};
+
+bool loadOpeningBook(OpeningBook* book, const char* path);
+bool saveOpeningBook(OpeningBook* book, const char* path);  // 保存前に整列・重複除去する
+bool probeOpeningBook(const OpeningBook* book, uint64_t hash, uint16_t* columnKey);
+
+#endif // OPENING_BOOK_H
@@ -0,0 +1,86 @@
+#ifndef PUZZLE_API_H
+#define PUZZLE_API_H
+
+/*
+ * 外部ツール（Python の ctypes など）向けの安定したC API（共有ライブラリ puzzle）
+ * 対局の配列をまとめて扱い、バッファは呼び出し側が確保した平坦な配列を使うので
+ * 言語の境界を越えるのはバッチごとに1回で済む
+ *
+ * 互換性の約束: 同じメジャーバージョンの間は関数の削除・引数の変更をしない（追加のみ）
+ * 盤面の値は CellValue（0 = 無効, 1 = +1, -1 = -1, 2 = +2）、列の状態は 0 = 未塗装, 1 = 赤, 2 = 青、
+ * 手番は 1 = 赤, 2 = 青 で、ヘッダ rules.h の列挙と同じ値を使う
+ */
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+  #if defined(PUZZLE_API_BUILD)
+    #define PUZZLE_API __declspec(dllexport)
+  #else
+    #define PUZZLE_API __declspec(dllimport)
+  #endif
+#else
+  #define PUZZLE_API __attribute__((visibility("default")))
+#endif
+
+#define PUZZLE_API_VERSION_MAJOR 1
+#define PUZZLE_API_VERSION_MINOR 1
+
+/* 戻り値 */
+#define PUZZLE_OK 0
+#define PUZZLE_ERROR_ARGUMENT -1      /* NULL・範囲外の添字・解釈できない操作指定 */
+#define PUZZLE_ERROR_MEMORY -2        /* メモリを確保できない（1.1 から） */
+#define PUZZLE_ERROR_INTERNAL -3      /* そのほかの内部エラー（スレッドを作れないなど。1.1 から） */
+
+/* どの関数も C++ の例外を呼び出し側に投げない。対局の配列を返す関数は失敗（引数・メモリとも）を NULL で返す */
+
+/* puzzle_step の対局ごとの結果 */
+#define PUZZLE_MOVE_PLAYED 1
+#define PUZZLE_MOVE_ILLEGAL 0         /* 選べない列（対局はそのまま） */
+#define PUZZLE_MOVE_GAME_OVER -1      /* 既に終局している */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PuzzleGames PuzzleGames;
+
+/* (メジャー << 16) | マイナー。読み込んだライブラリとヘッダの食い違いを確かめる */
+PUZZLE_API uint32_t puzzle_api_version(void);
+
+/* count 局を作る。対局 i は seeds[i]（NULL なら i）から始まる。失敗したら（確保できない場合も）NULL */
+PUZZLE_API PuzzleGames* puzzle_create(int32_t count, const uint64_t* seeds);
+PUZZLE_API void puzzle_destroy(PuzzleGames* games);
+PUZZLE_API int32_t puzzle_count(const PuzzleGames* games);
+
+/* indices の count 局（indices が NULL なら全局）を写した新しい配列を作る */
+PUZZLE_API PuzzleGames* puzzle_clone(const PuzzleGames* games, const int32_t* indices, int32_t count);
+
+/* 全局を seeds[i]（NULL なら i）から始め直す */
+PUZZLE_API int32_t puzzle_reset(PuzzleGames* games, const uint64_t* seeds);
+
+/* 対局 i で columns[i] の列を打つ（+2変化は演出なしですぐ反映）。results（NULL可）に対局ごとの結果を書く */
+PUZZLE_API int32_t puzzle_step(PuzzleGames* games, const int32_t* columns, int8_t* results);
+
+/*
+ * 全局の状態を書き出す（NULL の項目は書かない。各配列は対局の順に並べる）
+ *   board: count * 36（行優先） columnStates: count * 6 scores: count * 2（赤, 青）
+ *   status: count * 3（手番, +2変化が起きたか, 終局したか） plies: count
+ */
+PUZZLE_API int32_t puzzle_observe(const PuzzleGames* games, int8_t* board, int8_t* columnStates,
+                                  int32_t* scores, uint8_t* status, int32_t* plies);
+
+/* 全局で手番側が選べる列を count * 6 に 1/0 で書く */
+PUZZLE_API int32_t puzzle_legal_columns(const PuzzleGames* games, uint8_t* legal);
+
+/*
+ * controller（"greedy", "search:3", "random" など。"human" は不可）で全局の手番側の最善列を
+ * outColumns に書く（終局していれば -1）。対局は共有スレッドプールで分担する
+ */
+PUZZLE_API int32_t puzzle_evaluate(const PuzzleGames* games, const char* controller, int32_t* outColumns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PUZZLE_API_H */
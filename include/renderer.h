@@ -16,38 +16,120 @@ void setupGameRenderer();
 void renderGame();
 void cleanupGameRenderer();
 
+// 列ごとの勝率オーバーレイ（バックグラウンド解析）
+void setAnalysisOverlay(bool enabled);
+bool isAnalysisOverlayEnabled();
+
+// GL状態のキャッシュ（描画コードはプログラム・VAO・バッファ・テクスチャ・ブレンドをこれで設定する）
+// 描画は自分が必要な状態をすべて設定する（ブレンドも元に戻さず、不透明な描画は setBlend(false) を呼ぶ）
+typedef struct {
+	long long issued;   // GLを呼んだ数
+	long long elided;   // 同じ値だったので省いた数
+} GlStateStats;
+
+void resetGlStateCache();          // キャッシュを通さずに状態が変わったとき（オブジェクトの削除など）
+const GlStateStats* getGlStateStats();
+void useProgram(unsigned int program);
+unsigned int getCurrentProgram();  // glGetIntegerv(GL_CURRENT_PROGRAM) の代わり
+void bindVertexArray(unsigned int vao);
+void bindArrayBuffer(unsigned int buffer);
+void bindTexture2D(unsigned int texture);   // ユニット0
+void setBlend(bool enabled);       // 有効時の合成式は GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+
+// 頂点形式（形式ごとのVAOは作成時に属性を一度だけ設定し、描画は結合して転送するだけ）
+// 動的な頂点はすべて1本のリングバッファに書く（GL 4.4 以降は永続写像、GL 3.3 は orphaning）
+#define VERTEX_COLOR_FLOATS 6     // 位置3 + 色3
+#define VERTEX_TEXTURE_FLOATS 5   // 位置3 + テクスチャ座標2
+
+typedef enum {
+	VERTEX_FORMAT_COLOR,      // shaderProgram（格子線・文字・オーバーレイ）
+	VERTEX_FORMAT_TEXTURE,    // textureShaderProgram（画像）
+	VERTEX_FORMAT_COUNT
+} VertexFormat;
+
+void setupVertexFormats();
+void cleanupVertexFormats();
+int vertexFormatFloats(VertexFormat format);
+void configureVertexFormat(VertexFormat format);   // 結合中のVAO・頂点バッファに属性を設定する
+// 頂点 vertexCount 個分の書き込み先を確保する。書いたら他の確保より先に drawStreamVertices で描く
+// （確保できなければ NULL。1回の確保はリングバッファの1区画 256KB まで）
+float* allocStreamVertices(VertexFormat format, int vertexCount);
+void drawStreamVertices();   // 最後に確保した頂点を三角形リストとして描く
+void drawVertices(VertexFormat format, const float* vertices, int vertexCount);   // 確保・複写・描画をまとめて行う
+
 // シェーダー関連
 unsigned int compileShader(unsigned int type, const char* source);
 void setupShaders();
 void cleanupShaders();
 
-// テクスチャ関連
+// テクスチャ関連（画像は1枚のアトラスにまとめ、画像ごとのテクスチャ座標で引く）
+typedef enum {
+	SPRITE_PLUS_ONE,
+	SPRITE_PLUS_TWO,
+	SPRITE_MINUS_ONE,
+	SPRITE_COUNT
+} Sprite;
+
+typedef struct {
+	float u1, v1, u2, v2;    // アトラス内の左下と右上
+	bool loaded;             // 画像が読めなかったら false
+} AtlasRegion;
+
 void setupTextures();
 void cleanupTextures();
 unsigned int loadTexture(const char* path);
-void renderTexture(unsigned int texture, float x1, float y1, float x2, float y2);
+void renderSprite(Sprite sprite, float x1, float y1, float x2, float y2);
+
+// フォント（TTFから焼いた距離場のアトラス。焼いた結果は font/ にキャッシュし、次回からはそれを読む）
+#define FONT_FIRST_CHAR 32       // 空白から '~' まで
+#define FONT_CHAR_COUNT 95
+
+typedef struct {
+	float u1, v1, u2, v2;    // アトラス内の左下と右上
+	float x1, y1, x2, y2;    // ペン位置（基準線上）からの四角形（焼いたときの画素、y は上向き）
+	float advance;           // 送り幅（画素）
+} FontGlyph;
+
+void setupFont();
+void cleanupFont();
 
-// テキスト描画関連
+// テキスト描画関連（1文字1インスタンス、文字列ごとに1回の描画）
+// フォントが読めていれば距離場で、読めなければ8x8のビットマップと7セグメントで描く
+// beginTextBatch から endTextBatch までの文字列はまとめて1回で描く（間にほかの描画を挟まないこと）
 void setupTextRenderer();
 void cleanupTextRenderer();
+void beginTextBatch();
+void endTextBatch();
 void renderChar(char c, float x, float y, float scale, float color[3]);
 void renderText(const char* text, float x, float y, float scale, float color[3]);
+float measureText(const char* text, float scale);   // renderText で進む幅
 void renderScore(int redScore, int blueScore);
 void renderGameOverScreen(Player winner);
 
 // グローバル変数の宣言
 extern unsigned int shaderProgram;
 extern unsigned int textureShaderProgram;
+extern unsigned int cellShaderProgram;
+extern unsigned int glyphShaderProgram;
+extern unsigned int fontShaderProgram;
 extern const char* vertexShaderSource;
 extern const char* fragmentShaderSource;
 extern const char* textureVertexShaderSource;
 extern const char* textureFragmentShaderSource;
-extern unsigned int gameVAO, gameVBO;
-extern unsigned int textureVAO, textureVBO;
-extern unsigned int plusOneTexture, minusOneTexture, plusTwoTexture;
+extern const char* cellVertexShaderSource;
+extern const char* cellFragmentShaderSource;
+extern const char* glyphVertexShaderSource;
+extern const char* glyphFragmentShaderSource;
+extern const char* fontVertexShaderSource;
+extern const char* fontFragmentShaderSource;
+extern unsigned int atlasTexture;
+extern AtlasRegion atlasRegions[SPRITE_COUNT];
+extern bool fontLoaded;
+extern unsigned int fontTexture;
+extern FontGlyph fontGlyphs[FONT_CHAR_COUNT];
+extern float fontCapHeight;   // 'H' の高さ（画素）
 
 // テキスト描画用の変数
-extern unsigned int textVAO, textVBO;
 extern unsigned int digitTextures[10];  // 0-9の数字テクスチャ
 
 
@@ -0,0 +1,63 @@
+#ifndef REPLAY_DB_H
+#define REPLAY_DB_H
+
+#include <stdint.h>
+#include "mapped_file.h"
+
+// 棋譜データベース形式（リトルエンディアン、各部は8バイト境界）
+//   ヘッダ 64バイト: "PZDB" / version(u32) / 対局数 / 局面数 / 出現数 / 対局表・ハッシュ表・開始位置表・出現表の位置（各u64）
+//   対局表:     ReplayGame[対局数]（棋譜ファイルでの順番が対局番号）
+//   ハッシュ表: u64[局面数]（canonicalPositionHash の昇順）
+//   開始位置表: u64[局面数 + 1]（各局面の出現が出現表のどこからどこまでか）
+//   出現表:     ReplayPosting[出現数]（局面ごとに対局番号・手数の昇順）
+// 開いたファイルはマップしたまま直接引くので、読み込み時にヒープへ展開しない
+#define REPLAY_DB_VERSION 1
+#define REPLAY_DB_FINAL_MOVE 0xFF   // 最終局面（次の手がない）
+
+typedef struct {
+    int16_t redScore;
+    int16_t blueScore;
+    uint16_t plies;
+    uint8_t winner;       // Player
+    uint8_t truncated;
+} ReplayGame;
+
+// 局面が現れた対局と手数、その局面で選ばれた列
+typedef struct {
+    uint32_t game;
+    uint16_t ply;
+    uint8_t column;       // REPLAY_DB_FINAL_MOVE なら最終局面
+    uint8_t reserved;
+} ReplayPosting;
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t gameCount;
+    uint64_t positionCount;
+    uint64_t postingCount;
+    uint64_t gamesOffset;
+    uint64_t hashesOffset;
+    uint64_t startsOffset;
+    uint64_t postingsOffset;
+} ReplayDbHeader;
+
+typedef struct {
+    MappedFile file;
+    const ReplayDbHeader* header;
+    const ReplayGame* games;
+    const uint64_t* hashes;
+    const uint64_t* starts;
+    const ReplayPosting* postings;
+} ReplayDatabase;
+
+// 棋譜ファイルから作る。対局の打ち直しは threads 本（0 = ハードウェアスレッド数）で並列に行う
+bool buildReplayDatabase(const char* recordPath, const char* databasePath, int threads);
+
+bool openReplayDatabase(ReplayDatabase* db, const char* path);
+void closeReplayDatabase(ReplayDatabase* db);
+
+// 局面の出現を返す（*postings は出現表の中を指す）。見つからなければ 0
+uint64_t findReplayPositions(const ReplayDatabase* db, uint64_t hash, const ReplayPosting** postings);
+
+#endif // REPLAY_DB_H
@@ -0,0 +1,77 @@
+#ifndef RULES_H
+#define RULES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ゲーム定数
+#define BOARD_SIZE 6
+
+// マスの状態
+enum CellValue {
+    INVALID = 0,
+    PLUS_ONE = 1,
+    MINUS_ONE = -1,
+    PLUS_TWO = 2
+};
+
+// プレイヤー
+enum Player {
+    PLAYER_RED = 1,
+    PLAYER_BLUE = 2,
+    PLAYER_TIE = 0  // 引き分け
+};
+
+// 列の状態
+enum ColumnState {
+    EMPTY = 0,
+    PAINTED_RED = 1,
+    PAINTED_BLUE = 2
+};
+
+// 演出状態
+enum EffectState {
+    NO_EFFECT = 0,
+    EFFECT_WAITING = 1,    // 0.5秒待機
+    EFFECT_DARKENING = 2   // 暗転演出
+};
+
+// ゲーム状態
+typedef struct {
+    CellValue board[BOARD_SIZE][BOARD_SIZE];  // 6x6のボード
+    ColumnState columnStates[BOARD_SIZE];     // 各列の状態
+    Player currentPlayer;                     // 現在のプレイヤー
+    int redScore;                             // 赤のスコア
+    int blueScore;                            // 青のスコア
+    bool gameOver;                            // ゲーム終了フラグ
+    int paintedColumns;                       // 塗られた列の数
+    bool waitingForAI;                        // AI待機中フラグ
+    double aiStartTime;                       // AI思考開始時間
+    EffectState effectState;                  // 演出状態
+    double effectStartTime;                   // 演出開始時間
+    bool plusTwoTriggered;                    // +2変化が発生したかのフラグ
+    int plies;                                // このゲームで打たれた手数
+    uint64_t rngState;                        // マス再生成用の乱数状態
+    uint32_t revision;                        // 盤面・スコアが変わるたびに増える
+} GameState;
+
+// 状態を引数に取るルール関数（GLFW非依存、複数ゲームの同時進行用）
+// 時刻の記録やAI待機の設定は呼び出し側（game.cpp）が行う
+void seedGame(GameState* state, uint64_t seed);
+uint32_t nextRandom(GameState* state);
+void initBoard(GameState* state);
+void resetGame(GameState* state);
+bool isColumnSelectable(const GameState* state, int col);
+bool selectColumn(GameState* state, int col);
+void calculateScore(GameState* state);
+bool isGameOver(const GameState* state);
+Player getWinner(const GameState* state);
+void switchPlayer(GameState* state);
+int countUnpaintedColumns(const GameState* state);
+void triggerPlusTwoEffect(GameState* state);
+void applyPlusTwoChange(GameState* state);
+
+// 演出を待たずに+2変化まで即座に適用する手（ヘッドレス対戦・AI探索用）
+bool playMove(GameState* state, int col);
+
+#endif // RULES_H
@@ -0,0 +1,90 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdio.h>
+#include "rules.h"
+
+struct OpeningBook;
+
+// 探索用の列キー: 列状態(2bit) | +1数(3bit) | +2数(3bit) | -1数(3bit)
+// マスの並びは得点に影響しないので、列は構成だけで表す
+#define COLUMN_KEY(state, plusOne, plusTwo, minusOne) \
+    (uint16_t)(((state) << 9) | ((plusOne) << 6) | ((plusTwo) << 3) | (minusOne))
+#define COLUMN_KEY_STATE(key)     (((key) >> 9) & 3)
+#define COLUMN_KEY_PLUS_ONE(key)  (((key) >> 6) & 7)
+#define COLUMN_KEY_PLUS_TWO(key)  (((key) >> 3) & 7)
+#define COLUMN_KEY_MINUS_ONE(key) ((key) & 7)
+
+// 再生成結果の分類（空白・プラス・マイナスの個数の組）は28通り
+#define REROLL_CLASS_COUNT 28
+
+// 探索用の局面
+typedef struct {
+    uint16_t columns[BOARD_SIZE];  // 各列の列キー
+    int redScore;
+    int blueScore;
+    Player currentPlayer;
+    int paintedColumns;
+    bool plusTwoTriggered;
+    bool gameOver;
+} SearchPosition;
+
+// 再生成の分類（確率は 6!/(空白!プラス!マイナス!) / 3^6）
+typedef struct {
+    int invalidCount;
+    int plusCount;
+    int minusCount;
+    double probability;
+} RerollClass;
+
+const RerollClass* getRerollClasses();
+
+uint16_t getColumnKey(const GameState* state, int col);
+void makeSearchPosition(const GameState* state, SearchPosition* pos);
+
+// 列の並び順に依存しない局面ハッシュ（定跡やキャッシュのキー）
+uint64_t canonicalPositionHash(const SearchPosition* pos);
+
+// 列を選んで得点・列状態を更新する（再生成前）
+// 再生成は applyRerollClass で分類を指定して行う
+bool applySearchMove(SearchPosition* pos, int col);
+void applyRerollClass(SearchPosition* pos, int col, int rerollClass);
+
+// 探索設定
+typedef struct {
+    int depth;                       // 探索手数（列選択と再生成で1手）
+    const struct OpeningBook* book;  // 序盤定跡（NULLなら使わない）
+    int threads;                     // 1なら単一スレッド、それ以外はルートの手を共有スレッドプールで分担
+} SearchConfig;
+
+// 探索の統計（手ごと・対局ごとに addSearchStats で足し合わせる）
+typedef struct {
+    uint64_t nodes;           // 手番ノード
+    uint64_t chanceNodes;     // 確率ノード（列の再生成）
+    uint64_t leafNodes;       // 評価関数で止めた局面
+    uint64_t movesGenerated;  // 手番ノードで調べた手の数（平均分岐数 = movesGenerated / nodes）
+    uint64_t cutoffs;         // 省いた枝（同じ構成の列、最終手の再生成）
+    uint64_t cacheProbes;
+    uint64_t cacheHits;
+    uint64_t bookHits;
+    uint64_t searches;        // 集計した手の数
+    int maxDepth;             // 到達した最大の深さ（ルート=0）
+    double seconds;
+} SearchStats;
+
+void addSearchStats(SearchStats* total, const SearchStats* stats);
+
+// 統計ファイル（CSV）の見出しと1行
+void writeSearchStatsHeader(FILE* out);
+void writeSearchStatsRow(FILE* out, const char* kind, long long game, int ply, Player player, const SearchStats* stats);
+
+// 期待値最大化探索（再生成は確率ノード）で手番側の最善列キーを返す
+uint16_t searchBestColumnKey(const SearchPosition* pos, int depth);
+
+// 定跡を引き、なければ探索して最善列を返す（選べる列がなければ -1）
+int searchBestColumn(const GameState* state, const SearchConfig* config);
+
+// searchBestColumn と同じだが、この手の統計を stats に書き込む（NULL可）
+int searchBestColumnWithStats(const GameState* state, const SearchConfig* config, SearchStats* stats);
+
+#endif // SEARCH_H
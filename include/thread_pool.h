@@ -0,0 +1,76 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定数のワーカーで範囲処理を分担するスレッドプール
+// 呼び出し元スレッドもワーカー0として処理に参加する
+class ThreadPool {
+public:
+    // threadCount = 0 ならハードウェアスレッド数を使う
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 呼び出し元を含めた並列度
+    int size() const { return (int)workers.size() + 1; }
+
+    // [0, count) を grain 件ずつのチャンクに分けて body(begin, end, worker) を実行する
+    // ワーカーから入れ子で呼ばれた場合はその場で逐次実行する
+    void parallelFor(int count, int grain, const std::function<void(int, int, int)>& body);
+
+    // parallelFor と同じだが、最初に [0, count) をワーカー数で等分して配り、
+    // 自分の範囲を使い切ったワーカーは他のワーカーの残り範囲の後半を盗む
+    // 1件ごとの処理時間がばらつく場合（対局の長さなど）に使う
+    void parallelForStealing(int count, int grain, const std::function<void(int, int, int)>& body);
+
+private:
+    // ワーカーごとの未処理範囲（盗まれる側と盗む側で取り合うので個別にロックする）
+    struct alignas(64) WorkRange {
+        std::mutex mutex;
+        int begin = 0;
+        int end = 0;
+    };
+
+    void workerLoop(int worker);
+    void runJob(int count, int grain, bool stealing, const std::function<void(int, int, int)>& body);
+    void runChunks(int worker);
+    void runStealing(int worker);
+    bool takeOwnChunk(int worker, int* begin, int* end);
+    bool stealRange(int worker);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::mutex jobMutex;                 // parallelFor同士の直列化
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+
+    const std::function<void(int, int, int)>* body = nullptr;
+    int count = 0;
+    int grain = 1;
+    bool stealing = false;
+    std::atomic<int> nextIndex{0};
+    std::vector<std::unique_ptr<WorkRange>> ranges;
+    int activeWorkers = 0;
+    unsigned long generation = 0;
+    bool stopping = false;
+};
+
+// プロセス共通のスレッドプール（初回使用時に生成）
+ThreadPool& getSharedThreadPool();
+
+#define THREAD_POOL_BATCH_GRAIN 256   // 局面・対局のバッチを分けるときの1チャンクの件数
+
+// [0, count) を THREAD_POOL_BATCH_GRAIN 件ずつ共有スレッドプールで分担して body(begin, end) を実行する
+// threads == 1 か件数が1チャンク以下なら呼び出し元だけで回す
+void parallelForBatch(int count, int threads, const std::function<void(int, int)>& body);
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,54 @@
+#ifndef VEC_ENV_H
+#define VEC_ENV_H
+
+#include <stdint.h>
+#include <vector>
+#include "controller.h"
+
+// 強化学習用に複数の対局をまとめて1手ずつ進める環境
+// 終局（または MATCH_MAX_PLIES で打ち切り）した環境はその場で次の対局に入れ替える
+// 環境 i の k 局目は seedGame(seeds[i] + k * 0x9E3779B97F4A7C15) から始まる
+
+// 観測などの書き込み先（呼び出し側が確保した連続領域に環境の順で並べる。NULLの項目は書かない）
+typedef struct {
+    int8_t* board;           // count * 36（行優先の CellValue: 0, 1, -1, 2）
+    int8_t* columnStates;    // count * 6（ColumnState）
+    int32_t* scores;         // count * 2（赤, 青）
+    uint8_t* plusTwo;        // count（+2変化が起きていれば1）
+    uint8_t* currentPlayer;  // count（次に打つ側の Player）
+    uint8_t* legalColumns;   // count * 6（選べる列なら1）
+    float* rewards;          // count（手を打った側から見た点差の変化）
+    uint8_t* dones;          // count（0 = 継続、1 = 終局、2 = 打ち切り）
+} VecEnvBuffers;
+
+typedef struct {
+    int count;                  // 環境の数
+    uint64_t seed;              // seeds が NULL なら環境 i のシードは seed + i
+    const uint64_t* seeds;      // 環境ごとのシード（NULL可）
+    const Controller* opponent; // NULL なら両陣営とも actions で打つ（自己対戦）
+    Player agent;               // opponent があるとき actions で打つ側
+    int threads;                // 1 なら呼び出し元だけ、それ以外は共有スレッドプールで分担
+} VecEnvConfig;
+
+struct VecEnv {
+    std::vector<GameState> states;
+    std::vector<uint64_t> seeds;
+    std::vector<uint64_t> episodes;   // 環境ごとに始めた対局の数
+    Controller opponent;
+    bool hasOpponent = false;
+    Player agent = PLAYER_RED;
+    int threads = 0;
+};
+
+// opponent が人間なら false
+bool initVecEnv(VecEnv* env, const VecEnvConfig* config);
+
+// 全環境で新しい対局を始めて観測を書く（rewards と dones は 0）
+void resetVecEnv(VecEnv* env, const VecEnvBuffers* out);
+
+// 環境 i で actions[i] の列を打つ（選べない列なら選べる最小の列に置き換える）
+// opponent があれば相手の手番が終わるまで進めてから、報酬・終了・観測を書く
+// 終わった環境の観測は入れ替えた次の対局の最初の局面になる
+void stepVecEnv(VecEnv* env, const int* actions, const VecEnvBuffers* out);
+
+#endif // VEC_ENV_H
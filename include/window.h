@@ -10,7 +10,7 @@ GLFWwindow* createWindow(int width, int height, const char* title);
 bool initGLAD();
 void cleanup(GLFWwindow* window);
 
-// メインループ
-void mainLoop(GLFWwindow* window);
+// メインループ（renderOnDemand なら入力・状態の変化・演出があるときだけ描き、それ以外は眠る）
+void mainLoop(GLFWwindow* window, bool renderOnDemand);
 
 #endif // WINDOW_H
@@ -0,0 +1,176 @@
+#include "puzzle_api.h"
+#include "controller.h"
+#include "thread_pool.h"
+#include <string.h>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+struct PuzzleGames {
+    std::vector<GameState> states;
+};
+
+static void startGame(GameState* state, uint64_t seed) {
+    memset(state, 0, sizeof(*state));
+    seedGame(state, seed);
+    resetGame(state);
+}
+
+// C の呼び出し側に例外を渡さないよう、公開関数の本体はここを通す
+// 確保の失敗（巨大な count など）は PUZZLE_ERROR_MEMORY、それ以外（スレッドの生成など）は PUZZLE_ERROR_INTERNAL
+template <typename Body>
+static int32_t guardStatus(Body body) {
+    try {
+        return body();
+    } catch (const std::bad_alloc&) {
+        return PUZZLE_ERROR_MEMORY;
+    } catch (const std::length_error&) {
+        return PUZZLE_ERROR_MEMORY;
+    } catch (...) {
+        return PUZZLE_ERROR_INTERNAL;
+    }
+}
+
+// 対局の配列を返す関数用（失敗したら NULL）
+template <typename Body>
+static PuzzleGames* guardGames(Body body) {
+    try {
+        return body();
+    } catch (...) {
+        return NULL;
+    }
+}
+
+uint32_t puzzle_api_version(void) {
+    return ((uint32_t)PUZZLE_API_VERSION_MAJOR << 16) | PUZZLE_API_VERSION_MINOR;
+}
+
+PuzzleGames* puzzle_create(int32_t count, const uint64_t* seeds) {
+    return guardGames([&]() -> PuzzleGames* {
+        if (count <= 0) return NULL;
+        std::unique_ptr<PuzzleGames> games(new PuzzleGames);
+        games->states.resize(count);
+        if (puzzle_reset(games.get(), seeds) != PUZZLE_OK) return NULL;
+        return games.release();
+    });
+}
+
+void puzzle_destroy(PuzzleGames* games) {
+    delete games;
+}
+
+int32_t puzzle_count(const PuzzleGames* games) {
+    return games ? (int32_t)games->states.size() : 0;
+}
+
+PuzzleGames* puzzle_clone(const PuzzleGames* games, const int32_t* indices, int32_t count) {
+    return guardGames([&]() -> PuzzleGames* {
+        if (!games) return NULL;
+        if (!indices) count = (int32_t)games->states.size();
+        if (count <= 0) return NULL;
+        for (int32_t i = 0; indices && i < count; i++) {
+            if (indices[i] < 0 || indices[i] >= (int32_t)games->states.size()) return NULL;
+        }
+        std::unique_ptr<PuzzleGames> copy(new PuzzleGames);
+        copy->states.resize(count);
+        for (int32_t i = 0; i < count; i++) {
+            copy->states[i] = games->states[indices ? indices[i] : i];
+        }
+        return copy.release();
+    });
+}
+
+int32_t puzzle_reset(PuzzleGames* games, const uint64_t* seeds) {
+    return guardStatus([&]() -> int32_t {
+        if (!games) return PUZZLE_ERROR_ARGUMENT;
+        for (size_t i = 0; i < games->states.size(); i++) {
+            startGame(&games->states[i], seeds ? seeds[i] : (uint64_t)i);
+        }
+        return PUZZLE_OK;
+    });
+}
+
+int32_t puzzle_step(PuzzleGames* games, const int32_t* columns, int8_t* results) {
+    return guardStatus([&]() -> int32_t {
+        if (!games || !columns) return PUZZLE_ERROR_ARGUMENT;
+        parallelForBatch((int)games->states.size(), 0, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                GameState* state = &games->states[i];
+                int8_t result;
+                if (state->gameOver) {
+                    result = PUZZLE_MOVE_GAME_OVER;
+                } else {
+                    result = playMove(state, columns[i]) ? PUZZLE_MOVE_PLAYED : PUZZLE_MOVE_ILLEGAL;
+                }
+                if (results) results[i] = result;
+            }
+        });
+        return PUZZLE_OK;
+    });
+}
+
+int32_t puzzle_observe(const PuzzleGames* games, int8_t* board, int8_t* columnStates,
+                       int32_t* scores, uint8_t* status, int32_t* plies) {
+    return guardStatus([&]() -> int32_t {
+        if (!games) return PUZZLE_ERROR_ARGUMENT;
+        for (size_t i = 0; i < games->states.size(); i++) {
+            const GameState* state = &games->states[i];
+            if (board) {
+                for (int row = 0; row < BOARD_SIZE; row++) {
+                    for (int col = 0; col < BOARD_SIZE; col++) {
+                        board[(i * BOARD_SIZE + row) * BOARD_SIZE + col] = (int8_t)state->board[row][col];
+                    }
+                }
+            }
+            if (columnStates) {
+                for (int col = 0; col < BOARD_SIZE; col++) {
+                    columnStates[i * BOARD_SIZE + col] = (int8_t)state->columnStates[col];
+                }
+            }
+            if (scores) {
+                scores[i * 2] = state->redScore;
+                scores[i * 2 + 1] = state->blueScore;
+            }
+            if (status) {
+                status[i * 3] = (uint8_t)state->currentPlayer;
+                status[i * 3 + 1] = state->plusTwoTriggered ? 1 : 0;
+                status[i * 3 + 2] = state->gameOver ? 1 : 0;
+            }
+            if (plies) plies[i] = state->plies;
+        }
+        return PUZZLE_OK;
+    });
+}
+
+int32_t puzzle_legal_columns(const PuzzleGames* games, uint8_t* legal) {
+    return guardStatus([&]() -> int32_t {
+        if (!games || !legal) return PUZZLE_ERROR_ARGUMENT;
+        for (size_t i = 0; i < games->states.size(); i++) {
+            const GameState* state = &games->states[i];
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                legal[i * BOARD_SIZE + col] = !state->gameOver && isColumnSelectable(state, col) ? 1 : 0;
+            }
+        }
+        return PUZZLE_OK;
+    });
+}
+
+int32_t puzzle_evaluate(const PuzzleGames* games, const char* controller, int32_t* outColumns) {
+    return guardStatus([&]() -> int32_t {
+        Controller parsed;
+        if (!games || !controller || !outColumns || !parseController(controller, &parsed) ||
+            parsed.kind == CONTROLLER_HUMAN) {
+            return PUZZLE_ERROR_ARGUMENT;
+        }
+        // 探索AIはルートの手を並列にせず、対局の単位で分担する
+        parsed.search.threads = 1;
+        parallelForBatch((int)games->states.size(), 0, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                GameState state = games->states[i];   // chooseControllerMove は書き換え可能な状態を取るので写しを渡す
+                outColumns[i] = state.gameOver ? -1 : chooseControllerMove(&parsed, &state, NULL);
+            }
+        });
+        return PUZZLE_OK;
+    });
+}
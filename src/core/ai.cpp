@@ -0,0 +1,99 @@
+#include "ai.h"
+#include "thread_pool.h"
+
+// 列の6マスを2bitずつ詰めたキー（INVALID=0, +1=1, -1=2, +2=3）
+static int cellCode(CellValue v) {
+    switch (v) {
+        case PLUS_ONE: return 1;
+        case MINUS_ONE: return 2;
+        case PLUS_TWO: return 3;
+        default: return 0;
+    }
+}
+
+static int columnKey(const GameState* state, int col) {
+    int key = 0;
+    for (int row = 0; row < BOARD_SIZE; row++) {
+        key |= cellCode(state->board[row][col]) << (2 * row);
+    }
+    return key;
+}
+
+// 列キー → 評価順位（小さいほど良い）の表
+// 順位 = 空白マス数 * 64 + (32 - 列スコア)、元の比較（空白数→スコア）と同じ順序になる
+struct ColumnRankTable {
+    unsigned short rank[1 << (2 * BOARD_SIZE)];
+
+    ColumnRankTable() {
+        for (int key = 0; key < (1 << (2 * BOARD_SIZE)); key++) {
+            int invalidCount = 0;
+            int score = 0;
+            for (int row = 0; row < BOARD_SIZE; row++) {
+                switch ((key >> (2 * row)) & 3) {
+                    case 0: invalidCount++; break;
+                    case 1: score += 1; break;   // 青が+1マス → 青のスコア+1
+                    case 2: score -= 1; break;   // 青が-1マス → 赤のスコア-1（青には悪い）
+                    case 3: score += 2; break;   // 青が+2マス → 青のスコア+2
+                }
+            }
+            rank[key] = (unsigned short)(invalidCount * 64 + (32 - score));
+        }
+    }
+};
+
+static const ColumnRankTable& getColumnRankTable() {
+    static const ColumnRankTable table;
+    return table;
+}
+
+// 列の評価は打つ側から見たもの（どちらの色でも同じ表を使う）。終盤の特別処理だけ side の点差で判断する
+static int bestColumnWithTable(const GameState* state, const ColumnRankTable& table, Player side) {
+    // 残り一列で side のスコアが高い場合の特別処理
+    int lead = side == PLAYER_BLUE ? state->blueScore - state->redScore : state->redScore - state->blueScore;
+    if (countUnpaintedColumns(state) == 1 && lead > 0) {
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            if (state->columnStates[col] == EMPTY) {
+                return col;  // 勝利確定のためその列を選択
+            }
+        }
+    }
+
+    // 空白マスが少ない列を優先、同じ場合はスコアで決定（同順位なら左の列）
+    int bestColumn = -1;
+    int bestRank = 1 << 16;
+    for (int col = 0; col < BOARD_SIZE; col++) {
+        if (!isColumnSelectable(state, col)) continue;
+        int rank = table.rank[columnKey(state, col)];
+        if (rank < bestRank) {
+            bestRank = rank;
+            bestColumn = col;
+        }
+    }
+    return bestColumn;
+}
+
+int getBestColumnForBlue(const GameState* state) {
+    return bestColumnWithTable(state, getColumnRankTable(), PLAYER_BLUE);
+}
+
+int getGreedyColumn(const GameState* state) {
+    return bestColumnWithTable(state, getColumnRankTable(), state->currentPlayer);
+}
+
+// 1タスクあたりの局面数。これ未満のバッチは呼び出し元で逐次処理する
+static const int kBatchGrain = 256;
+
+void getBestColumnsForBlue(const GameState* states, int count, int* outColumns) {
+    const ColumnRankTable& table = getColumnRankTable();
+    auto evaluateRange = [&](int begin, int end, int) {
+        for (int i = begin; i < end; i++) {
+            outColumns[i] = bestColumnWithTable(&states[i], table, PLAYER_BLUE);
+        }
+    };
+
+    if (count < 2 * kBatchGrain) {
+        evaluateRange(0, count, 0);
+        return;
+    }
+    getSharedThreadPool().parallelFor(count, kBatchGrain, evaluateRange);
+}
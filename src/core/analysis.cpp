@@ -0,0 +1,138 @@
+#include "analysis.h"
+#include "ai.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// 1回の公開までに各列で行うプレイアウト数と、列ごとの上限
+#define ANALYSIS_BATCH 64
+#define ANALYSIS_MAX_SAMPLES 20000
+// 繰り返し塗り合って終わらない対局を打ち切る手数
+#define PLAYOUT_MAX_PLIES 200
+
+static std::thread analysisThread;
+static std::mutex analysisMutex;
+static std::condition_variable analysisWake;
+static bool analysisRunning = false;
+
+static GameState target;                 // 解析対象（analysisMutexで保護）
+static bool hasTarget = false;
+static unsigned long targetGeneration = 0;
+static AnalysisSnapshot published;       // 公開中の結果（analysisMutexで保護）
+
+// 1局を最後まで進め、viewer 視点の結果（勝ち=2、引き分け=1、負け=0）を返す
+// 方策は手番側の貪欲AIに2割のランダム手を混ぜる
+static int runPlayout(GameState* state, Player viewer) {
+    for (int ply = 0; ply < PLAYOUT_MAX_PLIES && !state->gameOver; ply++) {
+        int col = -1;
+        if (nextRandom(state) % 5 == 0) {
+            int candidates[BOARD_SIZE];
+            int n = 0;
+            for (int c = 0; c < BOARD_SIZE; c++) {
+                if (isColumnSelectable(state, c)) candidates[n++] = c;
+            }
+            if (n > 0) col = candidates[nextRandom(state) % n];
+        } else {
+            col = getGreedyColumn(state);
+        }
+        if (col < 0 || !playMove(state, col)) break;
+    }
+
+    Player winner = getWinner(state);
+    if (winner == PLAYER_TIE) return 1;
+    return winner == viewer ? 2 : 0;
+}
+
+static void analysisLoop() {
+    uint64_t playoutSeed = 0x9E3779B97F4A7C15ULL;
+    for (;;) {
+        GameState root;
+        unsigned long generation;
+        {
+            std::unique_lock<std::mutex> lock(analysisMutex);
+            analysisWake.wait(lock, [] {
+                if (!analysisRunning || !hasTarget) return !analysisRunning;
+                // 全列が上限に達していれば新しい局面まで休む
+                for (int col = 0; col < BOARD_SIZE; col++) {
+                    if (isColumnSelectable(&target, col) && published.samples[col] < ANALYSIS_MAX_SAMPLES) return true;
+                }
+                return false;
+            });
+            if (!analysisRunning) return;
+            root = target;
+            generation = targetGeneration;
+        }
+
+        // 列ごとに1バッチ分のプレイアウトを行う（ロックは持たない）
+        int points[BOARD_SIZE] = {0};
+        int samples[BOARD_SIZE] = {0};
+        if (!root.gameOver) {
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                if (!isColumnSelectable(&root, col)) continue;
+                for (int i = 0; i < ANALYSIS_BATCH; i++) {
+                    GameState playout = root;
+                    seedGame(&playout, playoutSeed++);
+                    playMove(&playout, col);
+                    points[col] += runPlayout(&playout, root.currentPlayer);
+                    samples[col]++;
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(analysisMutex);
+        if (generation != targetGeneration) continue;  // 途中で局面が変わったので捨てる
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            if (samples[col] == 0) continue;
+            int total = published.samples[col] + samples[col];
+            float sum = published.winRate[col] * published.samples[col] + points[col] * 0.5f;
+            published.samples[col] = total;
+            published.winRate[col] = sum / total;
+        }
+        if (root.gameOver) {
+            // 終局局面は解析しない（上限扱いにして休ませる）
+            for (int col = 0; col < BOARD_SIZE; col++) published.samples[col] = ANALYSIS_MAX_SAMPLES;
+        }
+    }
+}
+
+void startAnalysis() {
+    std::lock_guard<std::mutex> lock(analysisMutex);
+    if (analysisRunning) return;
+    analysisRunning = true;
+    analysisThread = std::thread(analysisLoop);
+}
+
+void stopAnalysis() {
+    {
+        std::lock_guard<std::mutex> lock(analysisMutex);
+        if (!analysisRunning) return;
+        analysisRunning = false;
+    }
+    analysisWake.notify_all();
+    analysisThread.join();
+}
+
+void requestAnalysis(const GameState* state) {
+    {
+        std::lock_guard<std::mutex> lock(analysisMutex);
+        if (hasTarget && target.revision == state->revision) return;  // 局面が同じなら結果を再利用
+
+        target = *state;
+        hasTarget = true;
+        targetGeneration++;
+        published.revision = state->revision;
+        published.player = state->currentPlayer;
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            published.samples[col] = 0;
+            published.winRate[col] = 0.0f;
+        }
+    }
+    analysisWake.notify_all();
+}
+
+bool getAnalysisSnapshot(AnalysisSnapshot* snapshot) {
+    std::unique_lock<std::mutex> lock(analysisMutex, std::try_to_lock);
+    if (!lock.owns_lock() || !hasTarget) return false;
+    *snapshot = published;
+    return true;
+}
@@ -0,0 +1,94 @@
+#include "controller.h"
+#include "ai.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 探索AIの既定の手数
+#define DEFAULT_SEARCH_DEPTH 3
+
+bool parseController(const char* text, Controller* controller) {
+    memset(controller, 0, sizeof(*controller));
+    controller->search.depth = DEFAULT_SEARCH_DEPTH;
+    controller->search.book = NULL;
+    controller->search.threads = 1;
+
+    if (strcmp(text, "human") == 0) {
+        controller->kind = CONTROLLER_HUMAN;
+    } else if (strcmp(text, "greedy") == 0) {
+        controller->kind = CONTROLLER_GREEDY;
+    } else if (strcmp(text, "random") == 0) {
+        controller->kind = CONTROLLER_RANDOM;
+    } else if (strncmp(text, "search", 6) == 0) {
+        controller->kind = CONTROLLER_SEARCH;
+        if (text[6] == ':') {
+            controller->search.depth = atoi(text + 7);
+            if (controller->search.depth < 1) return false;
+        } else if (text[6] != '\0') {
+            return false;
+        }
+    } else if (strncmp(text, "script:", 7) == 0) {
+        controller->kind = CONTROLLER_SCRIPTED;
+        const char* p = text + 7;
+        while (*p && controller->scriptLength < CONTROLLER_MAX_SCRIPT) {
+            char* end;
+            long col = strtol(p, &end, 10);
+            if (end == p || col < 0 || col >= BOARD_SIZE) return false;
+            controller->script[controller->scriptLength++] = (int)col;
+            p = (*end == ',') ? end + 1 : end;
+            if (*end != ',' && *end != '\0') return false;
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void formatController(const Controller* controller, char* buffer, int bufferSize) {
+    switch (controller->kind) {
+        case CONTROLLER_HUMAN: snprintf(buffer, bufferSize, "human"); break;
+        case CONTROLLER_GREEDY: snprintf(buffer, bufferSize, "greedy"); break;
+        case CONTROLLER_RANDOM: snprintf(buffer, bufferSize, "random"); break;
+        case CONTROLLER_SEARCH: snprintf(buffer, bufferSize, "search:%d", controller->search.depth); break;
+        case CONTROLLER_SCRIPTED: snprintf(buffer, bufferSize, "script(%d)", controller->scriptLength); break;
+    }
+}
+
+// 盤面の乱数を進めると再生成がシードだけで決まらなくなる（棋譜が再現できない）ので、
+// 乱数の状態を混ぜた値から選び、状態そのものは変えない
+static int chooseRandomColumn(const GameState* state) {
+    int candidates[BOARD_SIZE];
+    int n = 0;
+    for (int col = 0; col < BOARD_SIZE; col++) {
+        if (isColumnSelectable(state, col)) candidates[n++] = col;
+    }
+    uint64_t z = state->rngState ^ ((uint64_t)state->plies * 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return n > 0 ? candidates[(uint32_t)(z >> 32) % n] : -1;
+}
+
+int chooseControllerMove(const Controller* controller, GameState* state, SearchStats* stats) {
+    if (state->gameOver) return -1;
+
+    switch (controller->kind) {
+        case CONTROLLER_HUMAN:
+            return -1;
+        case CONTROLLER_GREEDY:
+            return getGreedyColumn(state);
+        case CONTROLLER_SEARCH:
+            return searchBestColumnWithStats(state, &controller->search, stats);
+        case CONTROLLER_RANDOM:
+            return chooseRandomColumn(state);
+        case CONTROLLER_SCRIPTED: {
+            // 赤・青は交互に打つので自分の手番数は plies / 2
+            int index = state->plies / 2;
+            if (index < controller->scriptLength && isColumnSelectable(state, controller->script[index])) {
+                return controller->script[index];
+            }
+            return getGreedyColumn(state);
+        }
+    }
+    return -1;
+}
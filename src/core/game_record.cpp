@@ -0,0 +1,389 @@
+#include "game_record.h"
+#include <string.h>
+
+static const char kRecordMagic[4] = {'P', 'Z', 'G', 'R'};
+
+#define RECORD_HEADER_SIZE 16
+#define BLOCK_HEADER_SIZE 12
+
+#define RECORD_FLAG_SEEDED 1
+#define RECORD_FLAG_TRUNCATED 2
+
+static void putU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+// ---- CRC32（IEEE 802.3, 反転多項式 0xEDB88320） ----
+
+struct Crc32Table {
+    uint32_t entries[256];
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t size) {
+    static const Crc32Table table;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// ---- 記録 ----
+
+static uint8_t cellTrit(CellValue value) {
+    switch (value) {
+        case PLUS_ONE:
+        case PLUS_TWO: return 1;
+        case MINUS_ONE: return 2;
+        default: return 0;
+    }
+}
+
+void beginGameRecord(GameRecord* record, uint64_t seed) {
+    record->seeded = true;
+    record->seed = seed;
+    record->plies = 0;
+    record->plusTwoPly = -1;
+    record->redScore = 0;
+    record->blueScore = 0;
+    record->winner = PLAYER_TIE;
+    record->truncated = false;
+}
+
+void beginGameRecordFromBoard(GameRecord* record, const GameState* state) {
+    beginGameRecord(record, 0);
+    record->seeded = false;
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            record->board[i][j] = cellTrit(state->board[i][j]);
+        }
+    }
+}
+
+bool addGameRecordMove(GameRecord* record, int col, const GameState* after) {
+    if (record->plies >= GAME_RECORD_MAX_PLIES) return false;
+    record->columns[record->plies] = (uint8_t)col;
+    if (!record->seeded) {
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            record->rerolls[record->plies][i] = cellTrit(after->board[i][col]);
+        }
+    }
+    record->plies++;
+    // playMove のように+2変化がすぐ反映されていればここで記録する
+    if (record->plusTwoPly < 0 && after->plusTwoTriggered && after->effectState == NO_EFFECT) {
+        record->plusTwoPly = record->plies;
+    }
+    return true;
+}
+
+void markGameRecordPlusTwo(GameRecord* record) {
+    if (record->plusTwoPly < 0) record->plusTwoPly = record->plies;
+}
+
+void finishGameRecord(GameRecord* record, const GameState* state) {
+    record->redScore = state->redScore;
+    record->blueScore = state->blueScore;
+    record->winner = getWinner(state);
+    record->truncated = !state->gameOver;
+}
+
+bool replayGameRecord(const GameRecord* record, GameState* state,
+                      const std::function<void(const GameState*, int)>& visit) {
+    memset(state, 0, sizeof(*state));
+    seedGame(state, record->seed);
+    resetGame(state);
+
+    if (record->seeded) {
+        for (int ply = 0; ply < record->plies; ply++) {
+            if (visit) visit(state, ply);
+            if (!playMove(state, record->columns[ply])) return false;
+        }
+    } else {
+        static const CellValue plusValue[2] = {PLUS_ONE, PLUS_TWO};
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                uint8_t t = record->board[i][j];
+                state->board[i][j] = t == 1 ? PLUS_ONE : (t == 2 ? MINUS_ONE : INVALID);
+            }
+        }
+        for (int ply = 0; ply < record->plies; ply++) {
+            if (ply == record->plusTwoPly) {
+                applyPlusTwoChange(state);
+                state->effectState = NO_EFFECT;
+            }
+            if (visit) visit(state, ply);
+            // 乱数による再生成を記録の値で上書きする（+2発生後の再生成は+2）
+            bool wasTriggered = state->plusTwoTriggered;
+            int col = record->columns[ply];
+            if (!selectColumn(state, col)) return false;
+            for (int i = 0; i < BOARD_SIZE; i++) {
+                uint8_t t = record->rerolls[ply][i];
+                state->board[i][col] = t == 1 ? plusValue[wasTriggered] : (t == 2 ? MINUS_ONE : INVALID);
+            }
+        }
+    }
+    if (visit) visit(state, record->plies);
+    return state->redScore == record->redScore && state->blueScore == record->blueScore;
+}
+
+// ---- 符号化 ----
+
+static int putVarint(uint8_t* p, uint32_t v) {
+    int n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static int getVarint(const uint8_t* p, int size, uint32_t* v) {
+    *v = 0;
+    for (int n = 0; n < size && n < 5; n++) {
+        *v |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) return n + 1;
+    }
+    return -1;
+}
+
+static uint32_t zigzag(int v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int unzigzag(uint32_t v) {
+    return (int)(v >> 1) ^ -(int)(v & 1);
+}
+
+// 3値を1バイトに5個（3^5 = 243）詰める
+static int packTrits(const uint8_t* trits, int count, uint8_t* out) {
+    int n = 0;
+    for (int i = 0; i < count; i += 5) {
+        int value = 0;
+        for (int k = 4; k >= 0; k--) value = value * 3 + (i + k < count ? trits[i + k] : 0);
+        out[n++] = (uint8_t)value;
+    }
+    return n;
+}
+
+static bool unpackTrits(const uint8_t* in, int count, uint8_t* trits) {
+    for (int i = 0; i < count; i += 5) {
+        int value = in[i / 5];
+        if (value >= 243) return false;
+        for (int k = 0; k < 5 && i + k < count; k++) {
+            trits[i + k] = (uint8_t)(value % 3);
+            value /= 3;
+        }
+    }
+    return true;
+}
+
+int encodeGameRecord(const GameRecord* record, uint8_t* out) {
+    int n = 0;
+    out[n++] = (uint8_t)((record->seeded ? RECORD_FLAG_SEEDED : 0) | (record->truncated ? RECORD_FLAG_TRUNCATED : 0));
+    n += putVarint(out + n, (uint32_t)record->plies);
+    if (record->seeded) {
+        for (int i = 0; i < 8; i++) out[n++] = (uint8_t)(record->seed >> (8 * i));
+    }
+
+    // 列番号は 0..5 なので6進で3手ずつ（6^3 = 216）
+    for (int ply = 0; ply < record->plies; ply += 3) {
+        int value = 0;
+        for (int k = 2; k >= 0; k--) value = value * 6 + (ply + k < record->plies ? record->columns[ply + k] : 0);
+        out[n++] = (uint8_t)value;
+    }
+
+    if (!record->seeded) {
+        uint8_t trits[BOARD_SIZE * BOARD_SIZE + GAME_RECORD_MAX_PLIES * BOARD_SIZE];
+        memcpy(trits, record->board, BOARD_SIZE * BOARD_SIZE);
+        memcpy(trits + BOARD_SIZE * BOARD_SIZE, record->rerolls, (size_t)record->plies * BOARD_SIZE);
+        n += packTrits(trits, BOARD_SIZE * BOARD_SIZE + record->plies * BOARD_SIZE, out + n);
+        n += putVarint(out + n, (uint32_t)(record->plusTwoPly + 1));
+    }
+
+    n += putVarint(out + n, zigzag(record->redScore));
+    n += putVarint(out + n, zigzag(record->blueScore));
+    return n;
+}
+
+int decodeGameRecord(const uint8_t* data, int size, GameRecord* record) {
+    if (size < 1) return -1;
+    int n = 0;
+    uint8_t flags = data[n++];
+    uint32_t plies;
+    int used = getVarint(data + n, size - n, &plies);
+    if (used < 0 || plies > GAME_RECORD_MAX_PLIES) return -1;
+    n += used;
+
+    beginGameRecord(record, 0);
+    record->seeded = (flags & RECORD_FLAG_SEEDED) != 0;
+    record->truncated = (flags & RECORD_FLAG_TRUNCATED) != 0;
+    record->plies = (int)plies;
+    if (record->seeded) {
+        if (size - n < 8) return -1;
+        for (int i = 0; i < 8; i++) record->seed |= (uint64_t)data[n++] << (8 * i);
+    }
+
+    int columnBytes = (record->plies + 2) / 3;
+    if (size - n < columnBytes) return -1;
+    for (int ply = 0; ply < record->plies; ply += 3) {
+        int value = data[n++];
+        if (value >= 216) return -1;
+        for (int k = 0; k < 3 && ply + k < record->plies; k++) {
+            record->columns[ply + k] = (uint8_t)(value % 6);
+            value /= 6;
+        }
+    }
+
+    if (!record->seeded) {
+        int tritCount = BOARD_SIZE * BOARD_SIZE + record->plies * BOARD_SIZE;
+        int tritBytes = (tritCount + 4) / 5;
+        uint8_t trits[BOARD_SIZE * BOARD_SIZE + GAME_RECORD_MAX_PLIES * BOARD_SIZE];
+        if (size - n < tritBytes || !unpackTrits(data + n, tritCount, trits)) return -1;
+        n += tritBytes;
+        memcpy(record->board, trits, BOARD_SIZE * BOARD_SIZE);
+        memcpy(record->rerolls, trits + BOARD_SIZE * BOARD_SIZE, (size_t)record->plies * BOARD_SIZE);
+
+        uint32_t plusTwoPly;
+        used = getVarint(data + n, size - n, &plusTwoPly);
+        if (used < 0) return -1;
+        n += used;
+        record->plusTwoPly = (int)plusTwoPly - 1;
+    }
+
+    uint32_t red, blue;
+    used = getVarint(data + n, size - n, &red);
+    if (used < 0) return -1;
+    n += used;
+    used = getVarint(data + n, size - n, &blue);
+    if (used < 0) return -1;
+    n += used;
+    record->redScore = unzigzag(red);
+    record->blueScore = unzigzag(blue);
+    record->winner = record->redScore > record->blueScore ? PLAYER_RED :
+                     (record->blueScore > record->redScore ? PLAYER_BLUE : PLAYER_TIE);
+    return n;
+}
+
+// ---- 書き込み ----
+
+// ロックを取った状態で呼ぶ
+static bool flushBlock(GameRecordWriter* writer) {
+    if (writer->blockRecords == 0) return writer->ok;
+    uint8_t header[BLOCK_HEADER_SIZE];
+    putU32(header, (uint32_t)writer->block.size());
+    putU32(header + 4, writer->blockRecords);
+    putU32(header + 8, crc32Update(0, writer->block.data(), writer->block.size()));
+    if (writer->ok) {
+        writer->ok = fwrite(header, 1, sizeof(header), writer->fp) == sizeof(header) &&
+                     fwrite(writer->block.data(), 1, writer->block.size(), writer->fp) == writer->block.size();
+    }
+    writer->bytes += sizeof(header) + writer->block.size();
+    writer->block.clear();
+    writer->blockRecords = 0;
+    return writer->ok;
+}
+
+bool openGameRecordWriter(GameRecordWriter* writer, const char* path) {
+    writer->fp = fopen(path, "wb");
+    if (!writer->fp) return false;
+    // ブロック単位で書くので stdio のバッファは使わない
+    setvbuf(writer->fp, NULL, _IONBF, 0);
+    writer->block.clear();
+    writer->block.reserve(GAME_RECORD_BLOCK_SIZE);
+    writer->blockRecords = 0;
+    writer->records = 0;
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    memcpy(header, kRecordMagic, 4);
+    putU32(header + 4, GAME_RECORD_VERSION);
+    putU32(header + 8, GAME_RECORD_BLOCK_SIZE);
+    putU32(header + 12, 0);
+    writer->ok = fwrite(header, 1, sizeof(header), writer->fp) == sizeof(header);
+    writer->bytes = sizeof(header);
+    return writer->ok;
+}
+
+bool writeGameRecord(GameRecordWriter* writer, const GameRecord* record) {
+    uint8_t encoded[GAME_RECORD_MAX_BYTES];
+    int size = encodeGameRecord(record, encoded);
+
+    std::lock_guard<std::mutex> lock(writer->mutex);
+    if (writer->block.size() + size > GAME_RECORD_BLOCK_SIZE) flushBlock(writer);
+    writer->block.insert(writer->block.end(), encoded, encoded + size);
+    writer->blockRecords++;
+    writer->records++;
+    return writer->ok;
+}
+
+bool closeGameRecordWriter(GameRecordWriter* writer) {
+    if (!writer->fp) return false;
+    std::lock_guard<std::mutex> lock(writer->mutex);
+    flushBlock(writer);
+    bool ok = fclose(writer->fp) == 0 && writer->ok;
+    writer->fp = NULL;
+    return ok;
+}
+
+// ---- 読み込み ----
+
+bool openGameRecordReader(GameRecordReader* reader, const char* path) {
+    reader->fp = fopen(path, "rb");
+    if (!reader->fp) return false;
+    reader->block.clear();
+    reader->offset = 0;
+    reader->remaining = 0;
+    reader->blocks = 0;
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), reader->fp) != sizeof(header) ||
+        memcmp(header, kRecordMagic, 4) != 0 || getU32(header + 4) != GAME_RECORD_VERSION) {
+        fprintf(stderr, "棋譜ファイルの形式が不正です: %s\n", path);
+        closeGameRecordReader(reader);
+        return false;
+    }
+    return true;
+}
+
+int readGameRecord(GameRecordReader* reader, GameRecord* record) {
+    while (reader->remaining == 0) {
+        uint8_t header[BLOCK_HEADER_SIZE];
+        size_t got = fread(header, 1, sizeof(header), reader->fp);
+        if (got == 0) return 0;
+        if (got != sizeof(header)) return -1;
+
+        uint32_t size = getU32(header);
+        if (size > GAME_RECORD_BLOCK_SIZE) return -1;
+        reader->block.resize(size);
+        if (fread(reader->block.data(), 1, size, reader->fp) != size ||
+            crc32Update(0, reader->block.data(), size) != getU32(header + 8)) {
+            return -1;
+        }
+        reader->offset = 0;
+        reader->remaining = getU32(header + 4);
+        reader->blocks++;
+    }
+
+    int used = decodeGameRecord(reader->block.data() + reader->offset,
+                                (int)(reader->block.size() - reader->offset), record);
+    if (used < 0) return -1;
+    reader->offset += used;
+    reader->remaining--;
+    return 1;
+}
+
+void closeGameRecordReader(GameRecordReader* reader) {
+    if (reader->fp) fclose(reader->fp);
+    reader->fp = NULL;
+}
@@ -0,0 +1,76 @@
+#include "mapped_file.h"
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+bool mapFile(MappedFile* file, const char* path) {
+    memset(file, 0, sizeof(*file));
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(handle);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+
+    file->data = (const uint8_t*)view;
+    file->size = (size_t)size.QuadPart;
+    file->fileHandle = handle;
+    file->mappingHandle = mapping;
+    return true;
+}
+
+void unmapFile(MappedFile* file) {
+    if (file->data) UnmapViewOfFile(file->data);
+    if (file->mappingHandle) CloseHandle((HANDLE)file->mappingHandle);
+    if (file->fileHandle) CloseHandle((HANDLE)file->fileHandle);
+    memset(file, 0, sizeof(*file));
+}
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool mapFile(MappedFile* file, const char* path) {
+    memset(file, 0, sizeof(*file));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // マップはファイルを閉じても残る
+    if (view == MAP_FAILED) return false;
+    // 索引は二分探索で飛び飛びに読むので先読みを抑える
+    madvise(view, (size_t)st.st_size, MADV_RANDOM);
+
+    file->data = (const uint8_t*)view;
+    file->size = (size_t)st.st_size;
+    return true;
+}
+
+void unmapFile(MappedFile* file) {
+    if (file->data) munmap((void*)file->data, file->size);
+    memset(file, 0, sizeof(*file));
+}
+#endif
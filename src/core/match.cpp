@@ -0,0 +1,129 @@
+#include "match.h"
+#include "thread_pool.h"
+#include <chrono>
+#include <mutex>
+#include <string.h>
+#include <vector>
+
+bool playMatch(const Controller* red, const Controller* blue, uint64_t seed, MatchResult* result,
+               GameRecord* record) {
+    if (red->kind == CONTROLLER_HUMAN || blue->kind == CONTROLLER_HUMAN) return false;
+
+    GameState state;
+    memset(&state, 0, sizeof(state));
+    seedGame(&state, seed);
+    resetGame(&state);
+    if (record) beginGameRecord(record, seed);
+
+    memset(&result->redStats, 0, sizeof(result->redStats));
+    memset(&result->blueStats, 0, sizeof(result->blueStats));
+    while (!state.gameOver && state.plies < MATCH_MAX_PLIES) {
+        bool redToMove = (state.currentPlayer == PLAYER_RED);
+        SearchStats moveStats;
+        memset(&moveStats, 0, sizeof(moveStats));
+        int col = chooseControllerMove(redToMove ? red : blue, &state, &moveStats);
+        addSearchStats(redToMove ? &result->redStats : &result->blueStats, &moveStats);
+        if (col < 0 || !playMove(&state, col)) break;
+        if (record && !addGameRecordMove(record, col, &state)) break;
+    }
+    if (record) finishGameRecord(record, &state);
+
+    result->winner = getWinner(&state);
+    result->redScore = state.redScore;
+    result->blueScore = state.blueScore;
+    result->plies = state.plies;
+    result->truncated = !state.gameOver;
+    return true;
+}
+
+void addMatchResult(MatchSummary* summary, const MatchResult* result) {
+    summary->games++;
+    if (result->winner == PLAYER_RED) summary->redWins++;
+    else if (result->winner == PLAYER_BLUE) summary->blueWins++;
+    else summary->ties++;
+    if (result->truncated) summary->truncated++;
+    summary->totalPlies += result->plies;
+    summary->redScoreSum += result->redScore;
+    summary->blueScoreSum += result->blueScore;
+    addSearchStats(&summary->redStats, &result->redStats);
+    addSearchStats(&summary->blueStats, &result->blueStats);
+}
+
+void mergeMatchSummary(MatchSummary* into, const MatchSummary* from) {
+    into->games += from->games;
+    into->redWins += from->redWins;
+    into->blueWins += from->blueWins;
+    into->ties += from->ties;
+    into->truncated += from->truncated;
+    into->totalPlies += from->totalPlies;
+    into->redScoreSum += from->redScoreSum;
+    into->blueScoreSum += from->blueScoreSum;
+    addSearchStats(&into->redStats, &from->redStats);
+    addSearchStats(&into->blueStats, &from->blueStats);
+}
+
+bool runHeadlessGames(const Controller* red, const Controller* blue, int games, uint64_t seed,
+                      MatchSummary* summary, FILE* statsFile, GameRecordWriter* recordWriter) {
+    memset(summary, 0, sizeof(*summary));
+    if (red->kind == CONTROLLER_HUMAN || blue->kind == CONTROLLER_HUMAN) return false;
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // ワーカーごとに集計して最後にまとめる
+    ThreadPool& pool = getSharedThreadPool();
+    std::vector<MatchSummary> perWorker(pool.size());
+    memset(perWorker.data(), 0, perWorker.size() * sizeof(MatchSummary));
+    std::mutex statsMutex;
+    if (statsFile) writeSearchStatsHeader(statsFile);
+    pool.parallelFor(games, 8, [&](int begin, int end, int worker) {
+        GameRecord record;
+        for (int i = begin; i < end; i++) {
+            MatchResult result;
+            playMatch(red, blue, seed + (uint64_t)i, &result, recordWriter ? &record : NULL);
+            if (recordWriter) writeGameRecord(recordWriter, &record);
+            addMatchResult(&perWorker[worker], &result);
+            if (statsFile) {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                writeSearchStatsRow(statsFile, "game", i, result.plies, PLAYER_RED, &result.redStats);
+                writeSearchStatsRow(statsFile, "game", i, result.plies, PLAYER_BLUE, &result.blueStats);
+            }
+        }
+    });
+    for (const MatchSummary& part : perWorker) {
+        mergeMatchSummary(summary, &part);
+    }
+
+    summary->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return true;
+}
+
+// 探索AIの陣営だけ、手あたりのノード数・速度・キャッシュ命中率などを表示する
+static void printSearchStatsSummary(const char* side, const SearchStats* stats, FILE* out) {
+    if (stats->searches == 0) return;
+    uint64_t expanded = stats->nodes + stats->chanceNodes;
+    fprintf(out, "%s search: %llu moves, %.0f nodes/move, %.0f nodes/s, branching %.2f, "
+                 "cache hit %.1f%%, cutoffs %llu, book %llu, max depth %d, %.3f ms/move\n",
+            side, (unsigned long long)stats->searches,
+            (double)expanded / stats->searches,
+            stats->seconds > 0 ? expanded / stats->seconds : 0.0,
+            stats->nodes ? (double)stats->movesGenerated / stats->nodes : 0.0,
+            stats->cacheProbes ? 100.0 * stats->cacheHits / stats->cacheProbes : 0.0,
+            (unsigned long long)stats->cutoffs,
+            (unsigned long long)stats->bookHits,
+            stats->maxDepth,
+            1000.0 * stats->seconds / stats->searches);
+}
+
+void printMatchSummary(const MatchSummary* summary, FILE* out) {
+    int games = summary->games > 0 ? summary->games : 1;
+    fprintf(out, "games: %d (%.2fs, %.0f games/s)\n", summary->games, summary->seconds,
+            summary->seconds > 0 ? summary->games / summary->seconds : 0.0);
+    fprintf(out, "red wins: %d (%.1f%%)\n", summary->redWins, 100.0 * summary->redWins / games);
+    fprintf(out, "blue wins: %d (%.1f%%)\n", summary->blueWins, 100.0 * summary->blueWins / games);
+    fprintf(out, "ties: %d (%.1f%%)\n", summary->ties, 100.0 * summary->ties / games);
+    fprintf(out, "avg score: red %.2f / blue %.2f\n",
+            (double)summary->redScoreSum / games, (double)summary->blueScoreSum / games);
+    fprintf(out, "avg plies: %.1f (truncated %d)\n", (double)summary->totalPlies / games, summary->truncated);
+    printSearchStatsSummary("red", &summary->redStats, out);
+    printSearchStatsSummary("blue", &summary->blueStats, out);
+}
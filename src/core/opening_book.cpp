@@ -0,0 +1,112 @@
+#include "opening_book.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+static const char kBookMagic[4] = {'P', 'Z', 'B', 'K'};
+
+static void putU16(unsigned char* p, uint16_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static void putU32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static void putU64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint32_t getU32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t getU64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+#define BOOK_HEADER_SIZE 16
+#define BOOK_ENTRY_SIZE 10
+
+bool loadOpeningBook(OpeningBook* book, const char* path) {
+    book->entries.clear();
+    book->depth = 0;
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return false;
+
+    unsigned char header[BOOK_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), fp) != sizeof(header) ||
+        memcmp(header, kBookMagic, 4) != 0 || getU32(header + 4) != OPENING_BOOK_VERSION) {
+        fprintf(stderr, "定跡ファイルの形式が不正です: %s\n", path);
+        fclose(fp);
+        return false;
+    }
+
+    // 件数はファイルの大きさと突き合わせる（壊れたヘッダで巨大な確保をしない）
+    uint32_t count = getU32(header + 8);
+    long dataStart = ftell(fp);
+    fseek(fp, 0, SEEK_END);
+    long fileSize = ftell(fp);
+    if (dataStart < 0 || fileSize < 0 || fseek(fp, dataStart, SEEK_SET) != 0 ||
+        (uint64_t)(fileSize - dataStart) != (uint64_t)count * BOOK_ENTRY_SIZE) {
+        fprintf(stderr, "定跡ファイルの件数と大きさが合いません: %s\n", path);
+        fclose(fp);
+        return false;
+    }
+    book->entries.resize(count);
+    unsigned char record[BOOK_ENTRY_SIZE];
+    for (uint32_t i = 0; i < count; i++) {
+        if (fread(record, 1, sizeof(record), fp) != sizeof(record)) {
+            fprintf(stderr, "定跡ファイルが途中で終わっています: %s\n", path);
+            book->entries.clear();
+            fclose(fp);
+            return false;
+        }
+        book->entries[i].hash = getU64(record);
+        book->entries[i].columnKey = (uint16_t)(record[8] | (record[9] << 8));
+    }
+    book->depth = (int)getU32(header + 12);
+    fclose(fp);
+    return true;
+}
+
+bool saveOpeningBook(OpeningBook* book, const char* path) {
+    std::vector<BookEntry>& entries = book->entries;
+    std::sort(entries.begin(), entries.end(),
+              [](const BookEntry& a, const BookEntry& b) { return a.hash < b.hash; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const BookEntry& a, const BookEntry& b) { return a.hash == b.hash; }),
+                  entries.end());
+
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return false;
+
+    unsigned char header[BOOK_HEADER_SIZE];
+    memcpy(header, kBookMagic, 4);
+    putU32(header + 4, OPENING_BOOK_VERSION);
+    putU32(header + 8, (uint32_t)entries.size());
+    putU32(header + 12, (uint32_t)book->depth);
+    bool ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header);
+
+    unsigned char record[BOOK_ENTRY_SIZE];
+    for (size_t i = 0; ok && i < entries.size(); i++) {
+        putU64(record, entries[i].hash);
+        putU16(record + 8, entries[i].columnKey);
+        ok = fwrite(record, 1, sizeof(record), fp) == sizeof(record);
+    }
+    return fclose(fp) == 0 && ok;
+}
+
+bool probeOpeningBook(const OpeningBook* book, uint64_t hash, uint16_t* columnKey) {
+    const std::vector<BookEntry>& entries = book->entries;
+    auto it = std::lower_bound(entries.begin(), entries.end(), hash,
+                               [](const BookEntry& e, uint64_t h) { return e.hash < h; });
+    if (it == entries.end() || it->hash != hash) return false;
+    *columnKey = it->columnKey;
+    return true;
+}
@@ -0,0 +1,213 @@
+#include "replay_db.h"
+#include "game_record.h"
+#include "search.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static const char kDatabaseMagic[4] = {'P', 'Z', 'D', 'B'};
+
+static_assert(sizeof(ReplayDbHeader) == 64, "ReplayDbHeader must be 64 bytes");
+static_assert(sizeof(ReplayGame) == 8, "ReplayGame must be 8 bytes");
+static_assert(sizeof(ReplayPosting) == 8, "ReplayPosting must be 8 bytes");
+
+// 構築中の出現（ハッシュで整列してから書き出す）
+typedef struct {
+    uint64_t hash;
+    ReplayPosting posting;
+} PositionEntry;
+
+// マップした内容を構造体として直接読むので、リトルエンディアンの環境でしか開かない
+static bool isLittleEndian() {
+    uint16_t probe = 1;
+    uint8_t first;
+    memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+static uint64_t alignTo8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+static bool writePadding(FILE* fp, uint64_t* offset) {
+    static const uint8_t zeros[8] = {0};
+    uint64_t aligned = alignTo8(*offset);
+    size_t padding = (size_t)(aligned - *offset);
+    *offset = aligned;
+    return padding == 0 || fwrite(zeros, 1, padding, fp) == padding;
+}
+
+bool buildReplayDatabase(const char* recordPath, const char* databasePath, int threads) {
+    if (!isLittleEndian()) return false;
+
+    // 1. 棋譜を読み、符号化したまま並べる（GameRecord は大きいので展開は打ち直すときだけ）
+    GameRecordReader reader;
+    if (!openGameRecordReader(&reader, recordPath)) return false;
+    std::vector<uint8_t> encoded;
+    std::vector<uint64_t> encodedOffsets;
+    std::vector<ReplayGame> games;
+    std::vector<uint64_t> entryOffsets;  // 各対局の出現の開始位置（plies + 1 個ずつ）
+    uint64_t entryCount = 0;
+    static GameRecord record;
+    uint8_t buffer[GAME_RECORD_MAX_BYTES];
+    int status;
+    while ((status = readGameRecord(&reader, &record)) > 0) {
+        if (games.size() >= 0xFFFFFFFFu) {
+            fprintf(stderr, "対局が多すぎます: %s\n", recordPath);
+            closeGameRecordReader(&reader);
+            return false;
+        }
+        int size = encodeGameRecord(&record, buffer);
+        encodedOffsets.push_back(encoded.size());
+        encoded.insert(encoded.end(), buffer, buffer + size);
+
+        ReplayGame game;
+        game.redScore = (int16_t)record.redScore;
+        game.blueScore = (int16_t)record.blueScore;
+        game.plies = (uint16_t)record.plies;
+        game.winner = (uint8_t)record.winner;
+        game.truncated = record.truncated ? 1 : 0;
+        games.push_back(game);
+        entryOffsets.push_back(entryCount);
+        entryCount += (uint64_t)record.plies + 1;
+    }
+    closeGameRecordReader(&reader);
+    if (status < 0) {
+        fprintf(stderr, "棋譜ファイルが壊れています: %s\n", recordPath);
+        return false;
+    }
+    encodedOffsets.push_back(encoded.size());
+
+    // 2. 対局ごとに打ち直して各局面のハッシュを求める（書き込み先が決まっているのでロック不要）
+    std::vector<PositionEntry> entries(entryCount);
+    std::atomic<long long> failedGame(-1);
+    ThreadPool pool(threads);
+    pool.parallelFor((int)games.size(), 64, [&](int begin, int end, int) {
+        GameRecord* local = new GameRecord;
+        GameState state;
+        for (int g = begin; g < end; g++) {
+            int size = (int)(encodedOffsets[g + 1] - encodedOffsets[g]);
+            PositionEntry* out = &entries[entryOffsets[g]];
+            bool ok = decodeGameRecord(&encoded[encodedOffsets[g]], size, local) == size &&
+                      replayGameRecord(local, &state, [&](const GameState* s, int ply) {
+                          SearchPosition pos;
+                          makeSearchPosition(s, &pos);
+                          out[ply].hash = canonicalPositionHash(&pos);
+                          out[ply].posting.game = (uint32_t)g;
+                          out[ply].posting.ply = (uint16_t)ply;
+                          out[ply].posting.column = ply < local->plies ? local->columns[ply] : REPLAY_DB_FINAL_MOVE;
+                          out[ply].posting.reserved = 0;
+                      });
+            if (!ok) failedGame.store(g);
+        }
+        delete local;
+    });
+    if (failedGame.load() >= 0) {
+        fprintf(stderr, "棋譜を打ち直せません（対局 %lld）: %s\n", failedGame.load(), recordPath);
+        return false;
+    }
+    std::vector<uint8_t>().swap(encoded);
+
+    // 3. ハッシュ順（同じ局面の中では対局・手数順）に並べる
+    std::sort(entries.begin(), entries.end(), [](const PositionEntry& a, const PositionEntry& b) {
+        if (a.hash != b.hash) return a.hash < b.hash;
+        if (a.posting.game != b.posting.game) return a.posting.game < b.posting.game;
+        return a.posting.ply < b.posting.ply;
+    });
+    std::vector<uint64_t> hashes;
+    std::vector<uint64_t> starts;
+    for (uint64_t i = 0; i < entryCount; i++) {
+        if (i == 0 || entries[i].hash != entries[i - 1].hash) {
+            hashes.push_back(entries[i].hash);
+            starts.push_back(i);
+        }
+    }
+    starts.push_back(entryCount);
+
+    // 4. 書き出し
+    ReplayDbHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kDatabaseMagic, 4);
+    header.version = REPLAY_DB_VERSION;
+    header.gameCount = games.size();
+    header.positionCount = hashes.size();
+    header.postingCount = entryCount;
+    header.gamesOffset = sizeof(header);
+    header.hashesOffset = alignTo8(header.gamesOffset + games.size() * sizeof(ReplayGame));
+    header.startsOffset = header.hashesOffset + hashes.size() * sizeof(uint64_t);
+    header.postingsOffset = header.startsOffset + starts.size() * sizeof(uint64_t);
+
+    FILE* fp = fopen(databasePath, "wb");
+    if (!fp) return false;
+    uint64_t offset = sizeof(header);
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    ok = ok && fwrite(games.data(), sizeof(ReplayGame), games.size(), fp) == games.size();
+    offset += games.size() * sizeof(ReplayGame);
+    ok = ok && writePadding(fp, &offset);
+    ok = ok && fwrite(hashes.data(), sizeof(uint64_t), hashes.size(), fp) == hashes.size();
+    ok = ok && fwrite(starts.data(), sizeof(uint64_t), starts.size(), fp) == starts.size();
+
+    ReplayPosting chunk[4096];
+    for (uint64_t i = 0; ok && i < entryCount; i += 4096) {
+        size_t n = (size_t)std::min<uint64_t>(4096, entryCount - i);
+        for (size_t k = 0; k < n; k++) chunk[k] = entries[i + k].posting;
+        ok = fwrite(chunk, sizeof(ReplayPosting), n, fp) == n;
+    }
+    return fclose(fp) == 0 && ok;
+}
+
+bool openReplayDatabase(ReplayDatabase* db, const char* path) {
+    memset(db, 0, sizeof(*db));
+    if (!isLittleEndian() || !mapFile(&db->file, path)) return false;
+
+    const uint8_t* base = db->file.data;
+    size_t size = db->file.size;
+    const ReplayDbHeader* header = (const ReplayDbHeader*)base;
+    bool valid = size >= sizeof(ReplayDbHeader) &&
+                 memcmp(header->magic, kDatabaseMagic, 4) == 0 &&
+                 header->version == REPLAY_DB_VERSION &&
+                 header->gamesOffset + header->gameCount * sizeof(ReplayGame) <= size &&
+                 header->hashesOffset + header->positionCount * sizeof(uint64_t) <= size &&
+                 header->startsOffset + (header->positionCount + 1) * sizeof(uint64_t) <= size &&
+                 header->postingsOffset + header->postingCount * sizeof(ReplayPosting) <= size &&
+                 (header->hashesOffset | header->startsOffset | header->postingsOffset) % 8 == 0;
+    if (!valid) {
+        fprintf(stderr, "データベースの形式が不正です: %s\n", path);
+        closeReplayDatabase(db);
+        return false;
+    }
+
+    db->header = header;
+    db->games = (const ReplayGame*)(base + header->gamesOffset);
+    db->hashes = (const uint64_t*)(base + header->hashesOffset);
+    db->starts = (const uint64_t*)(base + header->startsOffset);
+    db->postings = (const ReplayPosting*)(base + header->postingsOffset);
+    return true;
+}
+
+void closeReplayDatabase(ReplayDatabase* db) {
+    unmapFile(&db->file);
+    memset(db, 0, sizeof(*db));
+}
+
+uint64_t findReplayPositions(const ReplayDatabase* db, uint64_t hash, const ReplayPosting** postings) {
+    const uint64_t* first = db->hashes;
+    const uint64_t* last = db->hashes + db->header->positionCount;
+    const uint64_t* it = std::lower_bound(first, last, hash);
+    if (it == last || *it != hash) {
+        *postings = NULL;
+        return 0;
+    }
+    uint64_t index = (uint64_t)(it - first);
+    uint64_t begin = db->starts[index];
+    uint64_t end = db->starts[index + 1];
+    if (begin > end || end > db->header->postingCount) {  // 壊れたファイルで範囲外を読まない
+        *postings = NULL;
+        return 0;
+    }
+    *postings = db->postings + begin;
+    return end - begin;
+}
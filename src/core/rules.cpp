@@ -0,0 +1,217 @@
+#include "rules.h"
+
+// splitmix64でシードを拡散してからxorshift64*で生成する
+void seedGame(GameState* state, uint64_t seed) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    state->rngState = z ? z : 0x2545F4914F6CDD1DULL;  // 0は不動点なので避ける
+}
+
+uint32_t nextRandom(GameState* state) {
+    uint64_t x = state->rngState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    state->rngState = x;
+    return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+void initBoard(GameState* state) {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            int randVal = nextRandom(state) % 3;
+            switch (randVal) {
+                case 0: state->board[i][j] = INVALID; break;
+                case 1: state->board[i][j] = PLUS_ONE; break;
+                case 2: state->board[i][j] = MINUS_ONE; break;
+            }
+        }
+    }
+    state->revision++;
+}
+
+void resetGame(GameState* state) {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        state->columnStates[i] = EMPTY;
+    }
+    state->currentPlayer = PLAYER_RED;
+    state->redScore = 0;
+    state->blueScore = 0;
+    state->gameOver = false;
+    state->paintedColumns = 0;
+    state->waitingForAI = false;
+    state->aiStartTime = 0.0;
+    // +2状態もリセット
+    state->effectState = NO_EFFECT;
+    state->effectStartTime = 0.0;
+    state->plusTwoTriggered = false;
+    state->plies = 0;
+
+    // ボードも再生成して+2マスを+1に戻す
+    initBoard(state);
+}
+
+// 未塗装の列数を数える
+int countUnpaintedColumns(const GameState* state) {
+    int count = 0;
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        if (state->columnStates[i] == EMPTY) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// +1を+2に変化させる処理（演出開始時刻は呼び出し側が記録する）
+void triggerPlusTwoEffect(GameState* state) {
+    if (state->plusTwoTriggered) return;  // 既に発生済み
+
+    // 演出開始（実際の変化は演出後に行う）
+    state->plusTwoTriggered = true;
+    state->effectState = EFFECT_WAITING;  // まず0.5秒待機
+    state->effectStartTime = 0.0;
+}
+
+// 実際に+1を+2に変更する関数
+void applyPlusTwoChange(GameState* state) {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            if (state->board[i][j] == PLUS_ONE) {
+                state->board[i][j] = PLUS_TWO;
+            }
+        }
+    }
+    state->revision++;
+}
+
+// 交互にしか塗れない
+bool isColumnSelectable(const GameState* state, int col) {
+    if (col < 0 || col >= BOARD_SIZE) return false;
+    if (state->columnStates[col] == PAINTED_RED && state->currentPlayer != PLAYER_BLUE) return false;
+    if (state->columnStates[col] == PAINTED_BLUE && state->currentPlayer != PLAYER_RED) return false;
+    return true;
+}
+
+bool selectColumn(GameState* state, int col) {
+    if (!isColumnSelectable(state, col)) return false;
+
+    // 初めて塗る場合のみカウント
+    bool firstPaint = (state->columnStates[col] == EMPTY);
+
+    // まず現在のマス配置でスコア計算（選択前の状態で）
+    if (state->currentPlayer == PLAYER_RED) {
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            if (state->board[i][col] == PLUS_ONE) {
+                state->redScore++;  // 赤が+1マス → 赤のスコア+1
+            } else if (state->board[i][col] == PLUS_TWO) {
+                state->redScore += 2;  // 赤が+2マス → 赤のスコア+2
+            } else if (state->board[i][col] == MINUS_ONE) {
+                state->blueScore--; // 赤が-1マス → 青のスコア-1
+            }
+        }
+    } else {
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            if (state->board[i][col] == PLUS_ONE) {
+                state->blueScore++; // 青が+1マス → 青のスコア+1
+            } else if (state->board[i][col] == PLUS_TWO) {
+                state->blueScore += 2; // 青が+2マス → 青のスコア+2
+            } else if (state->board[i][col] == MINUS_ONE) {
+                state->redScore--;  // 青が-1マス → 赤のスコア-1
+            }
+        }
+    }
+
+    // 列を塗る
+    if (state->currentPlayer == PLAYER_RED) {
+        state->columnStates[col] = PAINTED_RED;
+    } else {
+        state->columnStates[col] = PAINTED_BLUE;
+    }
+    if (firstPaint) state->paintedColumns++;
+    state->plies++;
+
+    // その列のマスを再生成
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        int randVal = nextRandom(state) % 3;
+        switch (randVal) {
+            case 0: state->board[i][col] = INVALID; break;
+            case 1:
+                // +2変化が発生済みなら+2を生成、そうでなければ+1を生成
+                state->board[i][col] = state->plusTwoTriggered ? PLUS_TWO : PLUS_ONE;
+                break;
+            case 2: state->board[i][col] = MINUS_ONE; break;
+        }
+    }
+
+    // 残り3列になったら+1を+2に変化
+    if (countUnpaintedColumns(state) == 3 && !state->plusTwoTriggered) {
+        triggerPlusTwoEffect(state);
+    }
+    state->revision++;
+
+    if (isGameOver(state)) {
+        state->gameOver = true;
+    } else {
+        switchPlayer(state);
+    }
+    return true;
+}
+
+bool playMove(GameState* state, int col) {
+    if (!selectColumn(state, col)) return false;
+
+    // 演出なしで+2変化をすぐに反映する
+    if (state->effectState != NO_EFFECT) {
+        applyPlusTwoChange(state);
+        state->effectState = NO_EFFECT;
+    }
+    return true;
+}
+
+void calculateScore(GameState* state) {
+    state->redScore = 0;
+    state->blueScore = 0;
+
+    // スコアの計算
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        if (state->columnStates[i] == PAINTED_RED) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                if (state->board[j][i] == PLUS_ONE) {
+                    state->redScore++;  // 赤が+1マス → 赤のスコア+1
+                } else if (state->board[j][i] == PLUS_TWO) {
+                    state->redScore += 2;  // 赤が+2マス → 赤のスコア+2
+                } else if (state->board[j][i] == MINUS_ONE) {
+                    state->blueScore--; // 赤が-1マス → 青のスコア-1
+                }
+            }
+        } else if (state->columnStates[i] == PAINTED_BLUE) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                if (state->board[j][i] == PLUS_ONE) {
+                    state->blueScore++; // 青が+1マス → 青のスコア+1
+                } else if (state->board[j][i] == PLUS_TWO) {
+                    state->blueScore += 2; // 青が+2マス → 青のスコア+2
+                } else if (state->board[j][i] == MINUS_ONE) {
+                    state->redScore--;  // 青が-1マス → 赤のスコア-1
+                }
+            }
+        }
+    }
+    state->revision++;
+}
+
+bool isGameOver(const GameState* state) {
+    return state->paintedColumns >= BOARD_SIZE;
+}
+
+Player getWinner(const GameState* state) {
+    if (state->redScore > state->blueScore) return PLAYER_RED;
+    if (state->blueScore > state->redScore) return PLAYER_BLUE;
+    return PLAYER_TIE;
+}
+
+// 手番を交代する（AI待機の設定はgame.cpp側で行う）
+void switchPlayer(GameState* state) {
+    state->currentPlayer = (state->currentPlayer == PLAYER_RED) ? PLAYER_BLUE : PLAYER_RED;
+}
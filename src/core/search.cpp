@@ -0,0 +1,417 @@
+#include "search.h"
+#include "opening_book.h"
+#include "thread_pool.h"
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// 再生成分類表（空白数・プラス数・マイナス数の全組み合わせ）
+struct RerollClassTable {
+    RerollClass classes[REROLL_CLASS_COUNT];
+
+    RerollClassTable() {
+        double factorial[BOARD_SIZE + 1];
+        factorial[0] = 1.0;
+        for (int i = 1; i <= BOARD_SIZE; i++) factorial[i] = factorial[i - 1] * i;
+        double total = 1.0;
+        for (int i = 0; i < BOARD_SIZE; i++) total *= 3.0;
+
+        int n = 0;
+        for (int invalid = 0; invalid <= BOARD_SIZE; invalid++) {
+            for (int plus = 0; invalid + plus <= BOARD_SIZE; plus++) {
+                int minus = BOARD_SIZE - invalid - plus;
+                classes[n].invalidCount = invalid;
+                classes[n].plusCount = plus;
+                classes[n].minusCount = minus;
+                classes[n].probability = factorial[BOARD_SIZE] /
+                    (factorial[invalid] * factorial[plus] * factorial[minus]) / total;
+                n++;
+            }
+        }
+    }
+};
+
+const RerollClass* getRerollClasses() {
+    static const RerollClassTable table;
+    return table.classes;
+}
+
+uint16_t getColumnKey(const GameState* state, int col) {
+    int plusOne = 0, plusTwo = 0, minusOne = 0;
+    for (int row = 0; row < BOARD_SIZE; row++) {
+        switch (state->board[row][col]) {
+            case PLUS_ONE: plusOne++; break;
+            case PLUS_TWO: plusTwo++; break;
+            case MINUS_ONE: minusOne++; break;
+            default: break;
+        }
+    }
+    return COLUMN_KEY(state->columnStates[col], plusOne, plusTwo, minusOne);
+}
+
+void makeSearchPosition(const GameState* state, SearchPosition* pos) {
+    for (int col = 0; col < BOARD_SIZE; col++) {
+        pos->columns[col] = getColumnKey(state, col);
+    }
+    pos->redScore = state->redScore;
+    pos->blueScore = state->blueScore;
+    pos->currentPlayer = state->currentPlayer;
+    pos->paintedColumns = state->paintedColumns;
+    pos->plusTwoTriggered = state->plusTwoTriggered;
+    pos->gameOver = state->gameOver;
+}
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+uint64_t canonicalPositionHash(const SearchPosition* pos) {
+    // 列キーを昇順に並べてから混ぜるので列の並び順に依存しない
+    uint16_t sorted[BOARD_SIZE];
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        uint16_t key = pos->columns[i];
+        int j = i;
+        while (j > 0 && sorted[j - 1] > key) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = key;
+    }
+
+    uint64_t h = 0x6A09E667F3BCC908ULL;
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        h = mix64(h ^ sorted[i]);
+    }
+    h = mix64(h ^ (uint64_t)(uint32_t)pos->redScore);
+    h = mix64(h ^ ((uint64_t)(uint32_t)pos->blueScore << 1));
+    h = mix64(h ^ ((uint64_t)pos->currentPlayer << 2) ^ ((uint64_t)pos->plusTwoTriggered << 4));
+    return h;
+}
+
+static bool isSearchColumnSelectable(const SearchPosition* pos, int col) {
+    int state = COLUMN_KEY_STATE(pos->columns[col]);
+    if (state == PAINTED_RED && pos->currentPlayer != PLAYER_BLUE) return false;
+    if (state == PAINTED_BLUE && pos->currentPlayer != PLAYER_RED) return false;
+    return true;
+}
+
+bool applySearchMove(SearchPosition* pos, int col) {
+    if (col < 0 || col >= BOARD_SIZE || !isSearchColumnSelectable(pos, col)) return false;
+
+    uint16_t key = pos->columns[col];
+    int gain = COLUMN_KEY_PLUS_ONE(key) + 2 * COLUMN_KEY_PLUS_TWO(key);
+    int loss = COLUMN_KEY_MINUS_ONE(key);
+    if (pos->currentPlayer == PLAYER_RED) {
+        pos->redScore += gain;
+        pos->blueScore -= loss;
+    } else {
+        pos->blueScore += gain;
+        pos->redScore -= loss;
+    }
+
+    if (COLUMN_KEY_STATE(key) == EMPTY) pos->paintedColumns++;
+    int painted = (pos->currentPlayer == PLAYER_RED) ? PAINTED_RED : PAINTED_BLUE;
+    pos->columns[col] = COLUMN_KEY(painted, COLUMN_KEY_PLUS_ONE(key), COLUMN_KEY_PLUS_TWO(key), COLUMN_KEY_MINUS_ONE(key));
+    return true;
+}
+
+void applyRerollClass(SearchPosition* pos, int col, int rerollClass) {
+    const RerollClass& rc = getRerollClasses()[rerollClass];
+    int state = COLUMN_KEY_STATE(pos->columns[col]);
+    if (pos->plusTwoTriggered) {
+        pos->columns[col] = COLUMN_KEY(state, 0, rc.plusCount, rc.minusCount);
+    } else {
+        pos->columns[col] = COLUMN_KEY(state, rc.plusCount, 0, rc.minusCount);
+    }
+
+    // 残り3列になったら+1を+2に変化（playMoveと同じく即時反映）
+    if (BOARD_SIZE - pos->paintedColumns == 3 && !pos->plusTwoTriggered) {
+        pos->plusTwoTriggered = true;
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            uint16_t key = pos->columns[i];
+            pos->columns[i] = COLUMN_KEY(COLUMN_KEY_STATE(key), 0,
+                COLUMN_KEY_PLUS_ONE(key) + COLUMN_KEY_PLUS_TWO(key), COLUMN_KEY_MINUS_ONE(key));
+        }
+    }
+
+    if (pos->paintedColumns >= BOARD_SIZE) {
+        pos->gameOver = true;
+    } else {
+        pos->currentPlayer = (pos->currentPlayer == PLAYER_RED) ? PLAYER_BLUE : PLAYER_RED;
+    }
+}
+
+// ---- 探索本体（評価値は常に赤視点：赤スコア - 青スコア） ----
+
+#define WIN_BONUS 50.0
+
+static double terminalValue(const SearchPosition* pos) {
+    int margin = pos->redScore - pos->blueScore;
+    if (margin > 0) return margin + WIN_BONUS;
+    if (margin < 0) return margin - WIN_BONUS;
+    return 0.0;
+}
+
+// 点差に、手番側が次に取れる最大得点の半分を加える
+static double leafValue(const SearchPosition* pos) {
+    int bestGain = 0;
+    for (int col = 0; col < BOARD_SIZE; col++) {
+        if (!isSearchColumnSelectable(pos, col)) continue;
+        uint16_t key = pos->columns[col];
+        int gain = COLUMN_KEY_PLUS_ONE(key) + 2 * COLUMN_KEY_PLUS_TWO(key) + COLUMN_KEY_MINUS_ONE(key);
+        if (gain > bestGain) bestGain = gain;
+    }
+    double tempo = 0.5 * bestGain;
+    return (pos->redScore - pos->blueScore) + (pos->currentPlayer == PLAYER_RED ? tempo : -tempo);
+}
+
+// スレッドごとの置換表（直接マップ方式）
+// 探索（searchRoot）ごとに世代を振り、同じ世代・同じ残り手数の項目だけ使う
+// （前の探索や別の設定の深い値を借りると、結果が実行順に左右される）
+typedef struct {
+    uint64_t hash;
+    double value;
+    int depth;
+    uint32_t generation;
+} CacheEntry;
+
+#define SEARCH_CACHE_BITS 16
+
+static std::atomic<uint32_t> searchGeneration{0};
+
+static CacheEntry* getSearchCache() {
+    static thread_local std::vector<CacheEntry> cache;
+    if (cache.empty()) {
+        cache.assign((size_t)1 << SEARCH_CACHE_BITS, CacheEntry{0, 0.0, -1, 0});
+    }
+    return cache.data();
+}
+
+// 1スレッド分の探索状態。統計はここに素の加算で数え、手の終わりにまとめる
+typedef struct {
+    CacheEntry* cache;
+    uint32_t generation;
+    SearchStats stats;
+} SearchContext;
+
+static void initSearchContext(SearchContext* ctx, uint32_t generation) {
+    ctx->cache = getSearchCache();
+    ctx->generation = generation;
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+}
+
+static double expectimax(SearchContext* ctx, const SearchPosition* pos, int depth, int ply);
+
+// 列を選んだ後、再生成の全分類について期待値を取る
+static double moveValue(SearchContext* ctx, const SearchPosition* pos, int col, int depth, int ply) {
+    SearchPosition next = *pos;
+    applySearchMove(&next, col);
+
+    // 最後の列を塗ったら再生成結果は勝敗に関係しない
+    if (next.paintedColumns >= BOARD_SIZE) {
+        ctx->stats.cutoffs++;
+        applyRerollClass(&next, col, 0);
+        return terminalValue(&next);
+    }
+
+    ctx->stats.chanceNodes++;
+    const RerollClass* classes = getRerollClasses();
+    double sum = 0.0;
+    for (int k = 0; k < REROLL_CLASS_COUNT; k++) {
+        SearchPosition child = next;
+        applyRerollClass(&child, col, k);
+        sum += classes[k].probability * expectimax(ctx, &child, depth - 1, ply + 1);
+    }
+    return sum;
+}
+
+// 同じ構成の列は同じ結果になるので、調べる列を重複なしで集める
+static int collectDistinctMoves(SearchContext* ctx, const SearchPosition* pos, int* moves) {
+    int count = 0;
+    for (int col = 0; col < BOARD_SIZE; col++) {
+        if (!isSearchColumnSelectable(pos, col)) continue;
+        bool duplicate = false;
+        for (int i = 0; i < count; i++) {
+            if (pos->columns[moves[i]] == pos->columns[col]) { duplicate = true; break; }
+        }
+        if (duplicate) {
+            ctx->stats.cutoffs++;
+            continue;
+        }
+        moves[count++] = col;
+    }
+    return count;
+}
+
+static double expectimax(SearchContext* ctx, const SearchPosition* pos, int depth, int ply) {
+    if (ply > ctx->stats.maxDepth) ctx->stats.maxDepth = ply;
+    if (pos->gameOver) return terminalValue(pos);
+    if (depth <= 0) {
+        ctx->stats.leafNodes++;
+        return leafValue(pos);
+    }
+
+    uint64_t hash = canonicalPositionHash(pos);
+    CacheEntry* entry = &ctx->cache[hash & (((uint64_t)1 << SEARCH_CACHE_BITS) - 1)];
+    ctx->stats.cacheProbes++;
+    if (entry->hash == hash && entry->depth == depth && entry->generation == ctx->generation) {
+        ctx->stats.cacheHits++;
+        return entry->value;
+    }
+
+    ctx->stats.nodes++;
+    int moves[BOARD_SIZE];
+    int moveCount = collectDistinctMoves(ctx, pos, moves);
+    ctx->stats.movesGenerated += moveCount;
+
+    bool maximize = (pos->currentPlayer == PLAYER_RED);
+    double best = maximize ? -1e9 : 1e9;
+    for (int i = 0; i < moveCount; i++) {
+        double value = moveValue(ctx, pos, moves[i], depth, ply);
+        if (maximize ? value > best : value < best) best = value;
+    }
+
+    entry->hash = hash;
+    entry->value = best;
+    entry->depth = depth;
+    entry->generation = ctx->generation;
+    return best;
+}
+
+void addSearchStats(SearchStats* total, const SearchStats* stats) {
+    total->nodes += stats->nodes;
+    total->chanceNodes += stats->chanceNodes;
+    total->leafNodes += stats->leafNodes;
+    total->movesGenerated += stats->movesGenerated;
+    total->cutoffs += stats->cutoffs;
+    total->cacheProbes += stats->cacheProbes;
+    total->cacheHits += stats->cacheHits;
+    total->bookHits += stats->bookHits;
+    total->searches += stats->searches;
+    if (stats->maxDepth > total->maxDepth) total->maxDepth = stats->maxDepth;
+    total->seconds += stats->seconds;
+}
+
+// ルートの各手を評価する。threads != 1 なら共有スレッドプールで手ごとに分担し、
+// ワーカーごとの統計を最後に足し合わせる
+static uint16_t searchRoot(const SearchPosition* pos, int depth, int threads, SearchStats* stats) {
+    if (depth < 1) depth = 1;
+
+    // 0 は未使用の項目と区別するため飛ばす
+    uint32_t generation = ++searchGeneration;
+    if (generation == 0) generation = ++searchGeneration;
+
+    SearchContext root;
+    initSearchContext(&root, generation);
+    root.stats.nodes++;
+    int moves[BOARD_SIZE];
+    int moveCount = collectDistinctMoves(&root, pos, moves);
+    root.stats.movesGenerated += moveCount;
+    if (moveCount == 0) return 0;
+
+    double values[BOARD_SIZE];
+    if (threads != 1 && moveCount > 1) {
+        ThreadPool& pool = getSharedThreadPool();
+        std::vector<SearchStats> perWorker(pool.size());
+        memset(perWorker.data(), 0, perWorker.size() * sizeof(SearchStats));
+        pool.parallelFor(moveCount, 1, [&](int begin, int end, int worker) {
+            SearchContext ctx;
+            initSearchContext(&ctx, generation);
+            for (int i = begin; i < end; i++) {
+                values[i] = moveValue(&ctx, pos, moves[i], depth, 0);
+            }
+            addSearchStats(&perWorker[worker], &ctx.stats);
+        });
+        for (const SearchStats& part : perWorker) {
+            addSearchStats(&root.stats, &part);
+        }
+    } else {
+        for (int i = 0; i < moveCount; i++) {
+            values[i] = moveValue(&root, pos, moves[i], depth, 0);
+        }
+    }
+
+    bool maximize = (pos->currentPlayer == PLAYER_RED);
+    int best = 0;
+    for (int i = 1; i < moveCount; i++) {
+        if (maximize ? values[i] > values[best] : values[i] < values[best]) best = i;
+    }
+    if (stats) addSearchStats(stats, &root.stats);
+    return pos->columns[moves[best]];
+}
+
+uint16_t searchBestColumnKey(const SearchPosition* pos, int depth) {
+    return searchRoot(pos, depth, 1, NULL);
+}
+
+// 列キーに一致する選択可能な列（左から最初のもの）
+static int findColumnByKey(const GameState* state, const SearchPosition* pos, uint16_t key) {
+    for (int col = 0; col < BOARD_SIZE; col++) {
+        if (pos->columns[col] == key && isColumnSelectable(state, col)) return col;
+    }
+    return -1;
+}
+
+int searchBestColumn(const GameState* state, const SearchConfig* config) {
+    return searchBestColumnWithStats(state, config, NULL);
+}
+
+int searchBestColumnWithStats(const GameState* state, const SearchConfig* config, SearchStats* stats) {
+    SearchStats moveStats;
+    memset(&moveStats, 0, sizeof(moveStats));
+    auto startTime = std::chrono::steady_clock::now();
+
+    SearchPosition pos;
+    makeSearchPosition(state, &pos);
+    int col = -1;
+    if (!pos.gameOver) {
+        // 定跡にあれば探索しない（定跡を作った探索が今の設定より浅ければ使わない）
+        uint16_t key;
+        if (config->book && config->book->depth >= config->depth &&
+            probeOpeningBook(config->book, canonicalPositionHash(&pos), &key)) {
+            col = findColumnByKey(state, &pos, key);
+            if (col >= 0) moveStats.bookHits++;
+        }
+        if (col < 0) {
+            col = findColumnByKey(state, &pos, searchRoot(&pos, config->depth, config->threads, &moveStats));
+        }
+    }
+
+    if (stats) {
+        moveStats.searches = 1;
+        moveStats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        *stats = moveStats;
+    }
+    return col;
+}
+
+void writeSearchStatsHeader(FILE* out) {
+    fprintf(out, "kind,game,ply,player,searches,nodes,chance_nodes,leaf_nodes,branching,cutoffs,"
+                 "cache_probes,cache_hits,hit_rate,book_hits,max_depth,seconds,nodes_per_sec\n");
+}
+
+void writeSearchStatsRow(FILE* out, const char* kind, long long game, int ply, Player player, const SearchStats* stats) {
+    uint64_t expanded = stats->nodes + stats->chanceNodes;
+    fprintf(out, "%s,%lld,%d,%s,%llu,%llu,%llu,%llu,%.3f,%llu,%llu,%llu,%.4f,%llu,%d,%.6f,%.0f\n",
+            kind, game, ply, player == PLAYER_RED ? "red" : "blue",
+            (unsigned long long)stats->searches,
+            (unsigned long long)stats->nodes,
+            (unsigned long long)stats->chanceNodes,
+            (unsigned long long)stats->leafNodes,
+            stats->nodes ? (double)stats->movesGenerated / stats->nodes : 0.0,
+            (unsigned long long)stats->cutoffs,
+            (unsigned long long)stats->cacheProbes,
+            (unsigned long long)stats->cacheHits,
+            stats->cacheProbes ? (double)stats->cacheHits / stats->cacheProbes : 0.0,
+            (unsigned long long)stats->bookHits,
+            stats->maxDepth,
+            stats->seconds,
+            stats->seconds > 0 ? expanded / stats->seconds : 0.0);
+}
@@ -0,0 +1,184 @@
+#include "thread_pool.h"
+
+// ワーカースレッド内かどうか（入れ子のparallelFor検出用）
+static thread_local bool insidePoolWorker = false;
+
+ThreadPool::ThreadPool(int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = (int)std::thread::hardware_concurrency();
+        if (threadCount <= 0) threadCount = 1;
+    }
+    for (int i = 0; i < threadCount; i++) {
+        ranges.emplace_back(new WorkRange());
+    }
+    for (int i = 1; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+void ThreadPool::runChunks(int worker) {
+    for (;;) {
+        int begin = nextIndex.fetch_add(grain);
+        if (begin >= count) break;
+        int end = begin + grain < count ? begin + grain : count;
+        (*body)(begin, end, worker);
+    }
+}
+
+bool ThreadPool::takeOwnChunk(int worker, int* begin, int* end) {
+    WorkRange& range = *ranges[worker];
+    std::lock_guard<std::mutex> lock(range.mutex);
+    if (range.begin >= range.end) return false;
+    *begin = range.begin;
+    *end = range.begin + grain < range.end ? range.begin + grain : range.end;
+    range.begin = *end;
+    return true;
+}
+
+// 残りが最も多いワーカーから後半を盗み、自分の範囲にする
+bool ThreadPool::stealRange(int worker) {
+    int n = (int)ranges.size();
+    for (;;) {
+        int victim = -1;
+        int most = 0;
+        for (int i = 1; i < n; i++) {
+            int candidate = (worker + i) % n;
+            WorkRange& range = *ranges[candidate];
+            std::lock_guard<std::mutex> lock(range.mutex);
+            if (range.end - range.begin > most) {
+                most = range.end - range.begin;
+                victim = candidate;
+            }
+        }
+        if (victim < 0) return false;  // どこにも残っていない
+
+        int stolenBegin, stolenEnd;
+        {
+            WorkRange& range = *ranges[victim];
+            std::lock_guard<std::mutex> lock(range.mutex);
+            int remaining = range.end - range.begin;
+            if (remaining <= 0) continue;  // 調べている間に取られたのでやり直す
+            int half = remaining > grain ? remaining / 2 : remaining;
+            stolenEnd = range.end;
+            stolenBegin = range.end - half;
+            range.end = stolenBegin;
+        }
+        WorkRange& own = *ranges[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = stolenBegin;
+        own.end = stolenEnd;
+        return true;
+    }
+}
+
+void ThreadPool::runStealing(int worker) {
+    int begin, end;
+    for (;;) {
+        while (takeOwnChunk(worker, &begin, &end)) {
+            (*body)(begin, end, worker);
+        }
+        if (!stealRange(worker)) break;
+    }
+}
+
+void ThreadPool::workerLoop(int worker) {
+    insidePoolWorker = true;
+    unsigned long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobReady.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        if (stealing) {
+            runStealing(worker);
+        } else {
+            runChunks(worker);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--activeWorkers == 0) jobDone.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(int count, int grain, const std::function<void(int, int, int)>& body) {
+    runJob(count, grain, false, body);
+}
+
+void ThreadPool::parallelForStealing(int count, int grain, const std::function<void(int, int, int)>& body) {
+    runJob(count, grain, true, body);
+}
+
+void ThreadPool::runJob(int count, int grain, bool stealing, const std::function<void(int, int, int)>& body) {
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+
+    // 小さな処理や入れ子呼び出しはその場で片付ける
+    if (workers.empty() || insidePoolWorker || count <= grain) {
+        for (int begin = 0; begin < count; begin += grain) {
+            body(begin, begin + grain < count ? begin + grain : count, 0);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> jobLock(jobMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->body = &body;
+        this->count = count;
+        this->grain = grain;
+        this->stealing = stealing;
+        nextIndex.store(0);
+        if (stealing) {
+            // 範囲を等分して配る（ワーカーはまだ待機中なのでロック不要）
+            int n = (int)ranges.size();
+            for (int i = 0; i < n; i++) {
+                ranges[i]->begin = (int)((long long)count * i / n);
+                ranges[i]->end = (int)((long long)count * (i + 1) / n);
+            }
+        }
+        activeWorkers = (int)workers.size();
+        generation++;
+    }
+    jobReady.notify_all();
+
+    insidePoolWorker = true;
+    if (stealing) {
+        runStealing(0);
+    } else {
+        runChunks(0);
+    }
+    insidePoolWorker = false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    jobDone.wait(lock, [&] { return activeWorkers == 0; });
+    this->body = nullptr;
+}
+
+ThreadPool& getSharedThreadPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void parallelForBatch(int count, int threads, const std::function<void(int, int)>& body) {
+    if (threads == 1 || count <= THREAD_POOL_BATCH_GRAIN) {
+        body(0, count);
+        return;
+    }
+    getSharedThreadPool().parallelFor(count, THREAD_POOL_BATCH_GRAIN, [&](int begin, int end, int) {
+        body(begin, end);
+    });
+}
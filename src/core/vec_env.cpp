@@ -0,0 +1,113 @@
+#include "vec_env.h"
+#include "match.h"
+#include "thread_pool.h"
+#include <string.h>
+
+static int scoreMargin(const GameState* state, Player player) {
+    int margin = state->redScore - state->blueScore;
+    return player == PLAYER_RED ? margin : -margin;
+}
+
+static bool isEpisodeOver(const GameState* state) {
+    return state->gameOver || state->plies >= MATCH_MAX_PLIES;
+}
+
+// 相手の手番が続く間は相手の手を打つ
+static void playOpponent(const VecEnv* env, GameState* state) {
+    if (!env->hasOpponent) return;
+    while (!isEpisodeOver(state) && state->currentPlayer != env->agent) {
+        int col = chooseControllerMove(&env->opponent, state, NULL);
+        if (col < 0 || !playMove(state, col)) break;
+    }
+}
+
+static void startEpisode(VecEnv* env, int i) {
+    GameState* state = &env->states[i];
+    seedGame(state, env->seeds[i] + env->episodes[i] * 0x9E3779B97F4A7C15ULL);
+    resetGame(state);
+    env->episodes[i]++;
+    playOpponent(env, state);
+}
+
+static void writeObservation(const GameState* state, int i, const VecEnvBuffers* out) {
+    if (out->board) {
+        int8_t* board = out->board + i * BOARD_SIZE * BOARD_SIZE;
+        for (int row = 0; row < BOARD_SIZE; row++) {
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                board[row * BOARD_SIZE + col] = (int8_t)state->board[row][col];
+            }
+        }
+    }
+    if (out->columnStates) {
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            out->columnStates[i * BOARD_SIZE + col] = (int8_t)state->columnStates[col];
+        }
+    }
+    if (out->scores) {
+        out->scores[i * 2] = state->redScore;
+        out->scores[i * 2 + 1] = state->blueScore;
+    }
+    if (out->plusTwo) out->plusTwo[i] = state->plusTwoTriggered ? 1 : 0;
+    if (out->currentPlayer) out->currentPlayer[i] = (uint8_t)state->currentPlayer;
+    if (out->legalColumns) {
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            out->legalColumns[i * BOARD_SIZE + col] = isColumnSelectable(state, col) ? 1 : 0;
+        }
+    }
+}
+
+static void forEachEnv(VecEnv* env, const std::function<void(int, int)>& body) {
+    parallelForBatch((int)env->states.size(), env->threads, body);
+}
+
+bool initVecEnv(VecEnv* env, const VecEnvConfig* config) {
+    if (config->count <= 0) return false;
+    if (config->opponent && config->opponent->kind == CONTROLLER_HUMAN) return false;
+
+    env->states.assign(config->count, GameState());
+    env->seeds.resize(config->count);
+    env->episodes.assign(config->count, 0);
+    for (int i = 0; i < config->count; i++) {
+        env->seeds[i] = config->seeds ? config->seeds[i] : config->seed + (uint64_t)i;
+    }
+    env->hasOpponent = config->opponent != NULL;
+    if (env->hasOpponent) env->opponent = *config->opponent;
+    env->agent = config->agent == PLAYER_BLUE ? PLAYER_BLUE : PLAYER_RED;
+    env->threads = config->threads;
+    return true;
+}
+
+void resetVecEnv(VecEnv* env, const VecEnvBuffers* out) {
+    forEachEnv(env, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            startEpisode(env, i);
+            if (out->rewards) out->rewards[i] = 0.0f;
+            if (out->dones) out->dones[i] = 0;
+            writeObservation(&env->states[i], i, out);
+        }
+    });
+}
+
+void stepVecEnv(VecEnv* env, const int* actions, const VecEnvBuffers* out) {
+    forEachEnv(env, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            GameState* state = &env->states[i];
+            Player mover = state->currentPlayer;
+            int before = scoreMargin(state, mover);
+
+            // 選べる列は終局前なら必ずある（未塗装の列が残っている）
+            int col = actions[i];
+            if (col < 0 || col >= BOARD_SIZE || !isColumnSelectable(state, col)) {
+                for (col = 0; col < BOARD_SIZE - 1 && !isColumnSelectable(state, col); col++) {}
+            }
+            playMove(state, col);
+            playOpponent(env, state);
+
+            if (out->rewards) out->rewards[i] = (float)(scoreMargin(state, mover) - before);
+            uint8_t done = state->gameOver ? 1 : (state->plies >= MATCH_MAX_PLIES ? 2 : 0);
+            if (out->dones) out->dones[i] = done;
+            if (done) startEpisode(env, i);
+            writeObservation(state, i, out);
+        }
+    });
+}
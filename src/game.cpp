@@ -1,264 +1,173 @@
 #include "game.h"
 #include <stdlib.h>
+#include <stdint.h>
 #include <time.h>
 #include <stdio.h>
+#include <string.h>
 #include <GLFW/glfw3.h>
 
 static GameState gameState;
 
+// 各陣営の操作（setControllerで変更しなければ赤=人間、青=探索AI）
+static Controller controllers[2];
+static bool controllersConfigured = false;
+
+static void configureDefaultControllers() {
+    if (controllersConfigured) return;
+    parseController("human", &controllers[0]);
+    parseController("search", &controllers[1]);
+    controllersConfigured = true;
+}
+
+void setController(Player player, const Controller* controller) {
+    configureDefaultControllers();
+    controllers[player == PLAYER_RED ? 0 : 1] = *controller;
+}
+
+const Controller* getController(Player player) {
+    configureDefaultControllers();
+    return &controllers[player == PLAYER_RED ? 0 : 1];
+}
+
+// 探索AIの統計（直前の手と、現在の対局の陣営ごとの合計）
+static SearchStats lastMoveStats;
+static SearchStats gameStats[2];
+static FILE* searchStatsFile = NULL;
+static long long gameNumber = 0;
+
+void setSearchStatsFile(FILE* fp) {
+    searchStatsFile = fp;
+    if (searchStatsFile) writeSearchStatsHeader(searchStatsFile);
+}
+
+const SearchStats* getLastMoveSearchStats() {
+    return &lastMoveStats;
+}
+
+const SearchStats* getGameSearchStats(Player player) {
+    return &gameStats[player == PLAYER_RED ? 0 : 1];
+}
+
+// 棋譜（乱数の状態は対局をまたいで続くので、初期盤面と再生成をそのまま記録する）
+static GameRecord currentRecord;
+static GameRecordWriter* gameRecordWriter = NULL;
+
+void setGameRecordWriter(GameRecordWriter* writer) {
+    gameRecordWriter = writer;
+}
+
+// 手番側が人間でなければAI待機状態にする
+static void beginTurn() {
+    if (gameState.gameOver || getController(gameState.currentPlayer)->kind == CONTROLLER_HUMAN) {
+        gameState.waitingForAI = false;
+        return;
+    }
+    gameState.waitingForAI = true;
+    gameState.aiStartTime = glfwGetTime();  // 現在時刻を記録
+}
+
 GameState* getGameState() { return &gameState; }
 
 void initGame() {
-    srand(time(NULL));
+    seedGame(&gameState, (uint64_t)time(NULL));
     resetGame();
 }
 
 void initBoard() {
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            int randVal = rand() % 3;
-            switch (randVal) {
-                case 0: gameState.board[i][j] = INVALID; break;
-                case 1: gameState.board[i][j] = PLUS_ONE; break;
-                case 2: gameState.board[i][j] = MINUS_ONE; break;
-            }
-        }
-    }
+    initBoard(&gameState);
 }
 
 void resetGame() {
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        gameState.columnStates[i] = EMPTY;
-    }
-    gameState.currentPlayer = PLAYER_RED;
-    gameState.redScore = 0;
-    gameState.blueScore = 0;
-    gameState.gameOver = false;
-    gameState.paintedColumns = 0;
-    gameState.waitingForAI = false;
-    gameState.aiStartTime = 0.0;
-    // +2状態もリセット
-    gameState.effectState = NO_EFFECT;
-    gameState.effectStartTime = 0.0;
-    gameState.plusTwoTriggered = false;
-    
-    // ボードも再生成して+2マスを+1に戻す
-    initBoard();
+    resetGame(&gameState);
+    beginGameRecordFromBoard(&currentRecord, &gameState);
+    memset(&lastMoveStats, 0, sizeof(lastMoveStats));
+    memset(gameStats, 0, sizeof(gameStats));
+    gameNumber++;
+    beginTurn();  // 赤がAIならすぐ考え始める
 }
 
 // 未塗装の列数を数える
 int countUnpaintedColumns() {
-    int count = 0;
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        if (gameState.columnStates[i] == EMPTY) {
-            count++;
-        }
-    }
-    return count;
+    return countUnpaintedColumns(&gameState);
 }
 
 // +1を+2に変化させる処理
 void triggerPlusTwoEffect() {
     if (gameState.plusTwoTriggered) return;  // 既に発生済み
-    
-    // 演出開始（実際の変化は演出後に行う）
-    gameState.plusTwoTriggered = true;
-    gameState.effectState = EFFECT_WAITING;  // まず0.5秒待機
+
+    triggerPlusTwoEffect(&gameState);
     gameState.effectStartTime = glfwGetTime();
 }
 
 // 実際に+1を+2に変更する関数
 void applyPlusTwoChange() {
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (gameState.board[i][j] == PLUS_ONE) {
-                gameState.board[i][j] = PLUS_TWO;
-            }
-        }
-    }
+    applyPlusTwoChange(&gameState);
+    markGameRecordPlusTwo(&currentRecord);
 }
 
 bool selectColumn(int col) {
-    if (col < 0 || col >= BOARD_SIZE) return false;
-
-    // 交互にしか塗れない
-    if (gameState.columnStates[col] == PAINTED_RED && gameState.currentPlayer != PLAYER_BLUE) return false;
-    if (gameState.columnStates[col] == PAINTED_BLUE && gameState.currentPlayer != PLAYER_RED) return false;
-
-    // 初めて塗る場合のみカウント
-    bool firstPaint = (gameState.columnStates[col] == EMPTY);
-
-    // まず現在のマス配置でスコア計算（選択前の状態で）
-    if (gameState.currentPlayer == PLAYER_RED) {
-        for (int i = 0; i < BOARD_SIZE; i++) {
-            if (gameState.board[i][col] == PLUS_ONE) {
-                gameState.redScore++;  // 赤が+1マス → 赤のスコア+1
-            } else if (gameState.board[i][col] == PLUS_TWO) {
-                gameState.redScore += 2;  // 赤が+2マス → 赤のスコア+2
-            } else if (gameState.board[i][col] == MINUS_ONE) {
-                gameState.blueScore--; // 赤が-1マス → 青のスコア-1
-            }
-        }
-    } else {
-        for (int i = 0; i < BOARD_SIZE; i++) {
-            if (gameState.board[i][col] == PLUS_ONE) {
-                gameState.blueScore++; // 青が+1マス → 青のスコア+1
-            } else if (gameState.board[i][col] == PLUS_TWO) {
-                gameState.blueScore += 2; // 青が+2マス → 青のスコア+2
-            } else if (gameState.board[i][col] == MINUS_ONE) {
-                gameState.redScore--;  // 青が-1マス → 赤のスコア-1
-            }
-        }
-    }
-
-    // 列を塗る
-    if (gameState.currentPlayer == PLAYER_RED) {
-        gameState.columnStates[col] = PAINTED_RED;
-    } else {
-        gameState.columnStates[col] = PAINTED_BLUE;
-    }
-    if (firstPaint) gameState.paintedColumns++;
-
-    // その列のマスを再生成
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        int randVal = rand() % 3;
-        switch (randVal) {
-            case 0: gameState.board[i][col] = INVALID; break;
-            case 1: 
-                // +2変化が発生済みなら+2を生成、そうでなければ+1を生成
-                gameState.board[i][col] = gameState.plusTwoTriggered ? PLUS_TWO : PLUS_ONE; 
-                break;
-            case 2: gameState.board[i][col] = MINUS_ONE; break;
-        }
+    bool wasTriggered = gameState.plusTwoTriggered;
+    if (!selectColumn(&gameState, col)) return false;
+    addGameRecordMove(&currentRecord, col, &gameState);
+    if (gameState.gameOver && gameRecordWriter) {
+        finishGameRecord(&currentRecord, &gameState);
+        writeGameRecord(gameRecordWriter, &currentRecord);
     }
 
-    // 残り3列になったら+1を+2に変化
-    if (countUnpaintedColumns() == 3 && !gameState.plusTwoTriggered) {
-        triggerPlusTwoEffect();
+    // 演出の開始時刻を記録
+    if (!wasTriggered && gameState.plusTwoTriggered) {
+        gameState.effectStartTime = glfwGetTime();
     }
 
-    if (isGameOver()) {
-        gameState.gameOver = true;
-    } else {
-        switchPlayer();
-    }
+    // 次の手番がAIなら待機状態にする
+    beginTurn();
     return true;
 }
 
 void calculateScore() {
-    gameState.redScore = 0;
-    gameState.blueScore = 0;
-    
-    // スコアの計算
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        if (gameState.columnStates[i] == PAINTED_RED) {
-            for (int j = 0; j < BOARD_SIZE; j++) {
-                if (gameState.board[j][i] == PLUS_ONE) {
-                    gameState.redScore++;  // 赤が+1マス → 赤のスコア+1
-                } else if (gameState.board[j][i] == PLUS_TWO) {
-                    gameState.redScore += 2;  // 赤が+2マス → 赤のスコア+2
-                } else if (gameState.board[j][i] == MINUS_ONE) {
-                    gameState.blueScore--; // 赤が-1マス → 青のスコア-1
-                }
-            }
-        } else if (gameState.columnStates[i] == PAINTED_BLUE) {
-            for (int j = 0; j < BOARD_SIZE; j++) {
-                if (gameState.board[j][i] == PLUS_ONE) {
-                    gameState.blueScore++; // 青が+1マス → 青のスコア+1
-                } else if (gameState.board[j][i] == PLUS_TWO) {
-                    gameState.blueScore += 2; // 青が+2マス → 青のスコア+2
-                } else if (gameState.board[j][i] == MINUS_ONE) {
-                    gameState.redScore--;  // 青が-1マス → 赤のスコア-1
-                }
-            }
-        }
-    }
+    calculateScore(&gameState);
 }
 
 bool isGameOver() {
-    return gameState.paintedColumns >= BOARD_SIZE;
+    return isGameOver(&gameState);
 }
 
 Player getWinner() {
-    if (gameState.redScore > gameState.blueScore) return PLAYER_RED;
-    if (gameState.blueScore > gameState.redScore) return PLAYER_BLUE;
-    return PLAYER_TIE;
+    return getWinner(&gameState);
 }
 
 void switchPlayer() {
-    gameState.currentPlayer = (gameState.currentPlayer == PLAYER_RED) ? PLAYER_BLUE : PLAYER_RED;
+    switchPlayer(&gameState);
     
-    // 青プレイヤーのターンになったらAI待機状態にする
-    if (gameState.currentPlayer == PLAYER_BLUE) {
-        gameState.waitingForAI = true;
-        gameState.aiStartTime = glfwGetTime();  // 現在時刻を記録
-    }
+    // 次の手番がAIなら待機状態にする
+    beginTurn();
 }
 
 int getBestColumnForBlue() {
-    int bestColumn = -1;
-    int minInvalidCells = BOARD_SIZE + 1;  // 最大値+1で初期化
-    int bestScore = -1000;  // スコアも考慮
-    
-    // 残り一列で青のスコアが高い場合の特別処理
-    int unpaintedCount = countUnpaintedColumns();
-    if (unpaintedCount == 1 && gameState.blueScore > gameState.redScore) {
-        // 塗られていない列を探して選択
-        for (int col = 0; col < BOARD_SIZE; col++) {
-            if (gameState.columnStates[col] == EMPTY) {
-                return col;  // 勝利確定のためその列を選択
-            }
-        }
-    }
-    
-    // 各列を評価
-    for (int col = 0; col < BOARD_SIZE; col++) {
-        // その列が選択可能かチェック
-        if (gameState.columnStates[col] == PAINTED_BLUE && gameState.currentPlayer != PLAYER_RED) continue;
-        if (gameState.columnStates[col] == PAINTED_RED && gameState.currentPlayer != PLAYER_BLUE) continue;
-        
-        // この列の空白マス（INVALID）数を数える
-        int invalidCount = 0;
-        int currentScore = 0;
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (gameState.board[j][col] == INVALID) {
-                invalidCount++;
-            } else if (gameState.board[j][col] == PLUS_ONE) {
-                currentScore += 1;  // 青が+1マス → 青のスコア+1
-            } else if (gameState.board[j][col] == PLUS_TWO) {
-                currentScore += 2;  // 青が+2マス → 青のスコア+2
-            } else if (gameState.board[j][col] == MINUS_ONE) {
-                currentScore -= 1;  // 青が-1マス → 赤のスコア-1（青には悪い）
-            }
-        }
-        
-        // 空白マスが少ない列を優先、同じ場合はスコアで決定
-        bool isBetter = false;
-        if (invalidCount < minInvalidCells) {
-            isBetter = true;
-        } else if (invalidCount == minInvalidCells && currentScore > bestScore) {
-            isBetter = true;
-        }
-        
-        if (isBetter) {
-            bestColumn = col;
-            minInvalidCells = invalidCount;
-            bestScore = currentScore;
-        }
-    }
-    
-    return bestColumn;
+    return getBestColumnForBlue(&gameState);
 }
 
 void updateAI() {
     if (gameState.waitingForAI && !gameState.gameOver) {
         double currentTime = glfwGetTime();
         if (currentTime - gameState.aiStartTime >= 1.0) {  // 1秒待機
-            int col = getBestColumnForBlue();
+            gameState.waitingForAI = false;
+            Player mover = gameState.currentPlayer;
+            int ply = gameState.plies;
+            memset(&lastMoveStats, 0, sizeof(lastMoveStats));
+            int col = chooseControllerMove(getController(mover), &gameState, &lastMoveStats);
+            if (lastMoveStats.searches > 0) {
+                addSearchStats(&gameStats[mover == PLAYER_RED ? 0 : 1], &lastMoveStats);
+                if (searchStatsFile) writeSearchStatsRow(searchStatsFile, "move", gameNumber, ply, mover, &lastMoveStats);
+            }
             if (col != -1) {
-                selectColumn(col);
+                selectColumn(col);  // 次もAIの手番なら再び待機状態になる
+            }
+            if (gameState.gameOver && searchStatsFile) {
+                writeSearchStatsRow(searchStatsFile, "game", gameNumber, gameState.plies, PLAYER_RED, &gameStats[0]);
+                writeSearchStatsRow(searchStatsFile, "game", gameNumber, gameState.plies, PLAYER_BLUE, &gameStats[1]);
+                fflush(searchStatsFile);
             }
-            gameState.waitingForAI = false;
         }
     }
 }
@@ -267,8 +176,8 @@ void mouseCallback(GLFWwindow* window, int button, int action, int mods) {
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
         if (gameState.gameOver) return;
         
-        // 赤プレイヤーのターンでないなら無視
-        if (gameState.currentPlayer != PLAYER_RED) return;
+        // 人間が操作する陣営のターンでないなら無視
+        if (getController(gameState.currentPlayer)->kind != CONTROLLER_HUMAN) return;
         
         // マウス座標を取得
         double xpos, ypos;
@@ -2,9 +2,124 @@
 #include "window.h"
 #include "renderer.h"
 #include "game.h"
+#include "match.h"
+#include "opening_book.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
-int main()
+static void printUsage()
 {
+	printf("usage: game [--red <controller>] [--blue <controller>] [--headless <games>] [--seed <n>] [--stats-file <csv>]\n");
+	printf("            [--record <file>] [--continuous]\n");
+	printf("  controller: human | greedy | search[:depth] | random | script:c0,c1,...\n");
+}
+
+int main(int argc, char** argv)
+{
+	Controller red, blue;
+	parseController("human", &red);
+	parseController("search", &blue);
+	int headlessGames = 0;
+	uint64_t seed = (uint64_t)time(NULL);
+	const char* statsPath = NULL;
+	const char* recordPath = NULL;
+	bool continuous = false;   // 変化がなくても毎フレーム描く（既定は必要なときだけ描く）
+
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		bool ok = true;
+		if (strcmp(argv[i], "--red") == 0 && hasValue)
+			ok = parseController(argv[++i], &red);
+		else if (strcmp(argv[i], "--blue") == 0 && hasValue)
+			ok = parseController(argv[++i], &blue);
+		else if (strcmp(argv[i], "--headless") == 0 && hasValue)
+			headlessGames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+			seed = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--stats-file") == 0 && hasValue)
+			statsPath = argv[++i];
+		else if (strcmp(argv[i], "--record") == 0 && hasValue)
+			recordPath = argv[++i];
+		else if (strcmp(argv[i], "--continuous") == 0)
+			continuous = true;
+		else
+			ok = false;
+		if (!ok)
+		{
+			printUsage();
+			return -1;
+		}
+	}
+
+	// 定跡があれば探索AIに使わせる
+	static OpeningBook openingBook;
+	if (loadOpeningBook(&openingBook, "opening_book.bin"))
+	{
+		printf("定跡読み込み成功: %zu局面 (depth %d)\n", openingBook.entries.size(), openingBook.depth);
+		if (red.kind == CONTROLLER_SEARCH) red.search.book = &openingBook;
+		if (blue.kind == CONTROLLER_SEARCH) blue.search.book = &openingBook;
+	}
+
+	// 探索統計の出力先
+	FILE* statsFile = NULL;
+	if (statsPath)
+	{
+		statsFile = fopen(statsPath, "w");
+		if (!statsFile)
+		{
+			fprintf(stderr, "統計ファイルを開けません: %s\n", statsPath);
+			return -1;
+		}
+	}
+
+	// 棋譜の出力先
+	static GameRecordWriter recordWriter;
+	GameRecordWriter* writer = NULL;
+	if (recordPath)
+	{
+		if (!openGameRecordWriter(&recordWriter, recordPath))
+		{
+			fprintf(stderr, "棋譜ファイルを開けません: %s\n", recordPath);
+			return -1;
+		}
+		writer = &recordWriter;
+	}
+
+	// ヘッドレスモード: ウィンドウもAIの待ち時間もなしで対局して集計を表示
+	if (headlessGames > 0)
+	{
+		if (red.kind == CONTROLLER_HUMAN || blue.kind == CONTROLLER_HUMAN)
+		{
+			fprintf(stderr, "ヘッドレスモードでは human を指定できません\n");
+			return -1;
+		}
+
+		char redName[32], blueName[32];
+		formatController(&red, redName, sizeof(redName));
+		formatController(&blue, blueName, sizeof(blueName));
+		printf("red: %s / blue: %s / seed: %llu\n", redName, blueName, (unsigned long long)seed);
+
+		MatchSummary summary;
+		runHeadlessGames(&red, &blue, headlessGames, seed, &summary, statsFile, writer);
+		printMatchSummary(&summary, stdout);
+		if (statsFile)
+			fclose(statsFile);
+		if (writer)
+			closeGameRecordWriter(writer);
+		return 0;
+	}
+
+	// ウィンドウでは1手ずつなので、探索はルートの手を全コアで分担する
+	red.search.threads = 0;
+	blue.search.threads = 0;
+	setController(PLAYER_RED, &red);
+	setController(PLAYER_BLUE, &blue);
+	setSearchStatsFile(statsFile);
+	setGameRecordWriter(writer);
+
 	if (!initGLFW())
 		return -1;
 
@@ -24,16 +139,20 @@ int main()
 	initGame();
 	
 	// レンダラーを初期化
-	setupShaders();
+	setupShaders();      // テクスチャ（アトラス）とフォントもここで準備する
 	setupGameRenderer();
-	setupTextures();
 
-	mainLoop(window);
+	mainLoop(window, !continuous);
 
 	// 解放
 	cleanupGameRenderer();
 	cleanupShaders();
 	cleanupTextures();
+	cleanupFont();
 	cleanup(window);
+	if (statsFile)
+		fclose(statsFile);
+	if (writer)
+		closeGameRecordWriter(writer);
 	return 0;
 }
@@ -0,0 +1,286 @@
+#include "renderer.h"
+#include "stb_truetype.h"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+bool fontLoaded = false;
+unsigned int fontTexture;
+FontGlyph fontGlyphs[FONT_CHAR_COUNT];
+float fontCapHeight;
+
+#define FONT_TTF_PATH "font/TikTokSans-Regular.ttf"
+#define FONT_CACHE_PATH "font/TikTokSans-Regular.sdf"
+
+// 焼き込みの設定（変えたら FONT_CACHE_VERSION も上げる）
+#define FONT_CACHE_VERSION 1
+#define FONT_BAKE_PIXELS 48      // アセントからディセントまでの高さ（画素）
+#define FONT_SDF_PADDING 6       // 輪郭の外側に残す距離（画素）
+#define FONT_SDF_ONEDGE 128      // 輪郭上の値（内側ほど大きい）
+#define FONT_ATLAS_WIDTH 512     // 4の倍数なので1行ずつの詰め直しは要らない
+#define FONT_ATLAS_SPACING 1
+
+#define FONT_CACHE_HEADER_SIZE 40
+#define FONT_GLYPH_FLOATS 9
+
+static const char kFontCacheMagic[4] = {'P', 'Z', 'F', 'N'};
+
+static void putU32(unsigned char* p, uint32_t v)
+{
+	for (int i = 0; i < 4; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static void putU64(unsigned char* p, uint64_t v)
+{
+	for (int i = 0; i < 8; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static void putF32(unsigned char* p, float v)
+{
+	uint32_t bits;
+	memcpy(&bits, &v, sizeof(bits));
+	putU32(p, bits);
+}
+
+static uint32_t getU32(const unsigned char* p)
+{
+	uint32_t v = 0;
+	for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+	return v;
+}
+
+static uint64_t getU64(const unsigned char* p)
+{
+	uint64_t v = 0;
+	for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+	return v;
+}
+
+static float getF32(const unsigned char* p)
+{
+	uint32_t bits = getU32(p);
+	float v;
+	memcpy(&v, &bits, sizeof(v));
+	return v;
+}
+
+// FNV-1a（TTFが差し替えられたらキャッシュを使わない）
+static uint64_t hashBytes(const std::vector<unsigned char>& bytes)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (unsigned char byte : bytes) {
+		hash ^= byte;
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static bool readFile(const char* path, std::vector<unsigned char>* bytes)
+{
+	FILE* fp = fopen(path, "rb");
+	if (!fp) return false;
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	bytes->resize(size > 0 ? (size_t)size : 0);
+	bool ok = size > 0 && fread(bytes->data(), 1, bytes->size(), fp) == bytes->size();
+	fclose(fp);
+	return ok;
+}
+
+typedef struct {
+	unsigned char* sdf;     // 上の行から（stbtt_GetCodepointSDF）
+	int width, height;
+	int x, y;               // アトラス内の左下
+} BakedGlyph;
+
+// 表示する ASCII の距離場を1文字ずつ作り、幅 FONT_ATLAS_WIDTH のアトラスに棚詰めする
+// 字形の位置と送り幅は FONT_BAKE_PIXELS の画素単位で fontGlyphs に書く
+static bool bakeFont(const std::vector<unsigned char>& ttf, std::vector<unsigned char>* pixels, int* atlasHeight)
+{
+	stbtt_fontinfo info;
+	if (!stbtt_InitFont(&info, ttf.data(), stbtt_GetFontOffsetForIndex(ttf.data(), 0))) return false;
+	float scale = stbtt_ScaleForPixelHeight(&info, FONT_BAKE_PIXELS);
+	float distScale = (float)FONT_SDF_ONEDGE / FONT_SDF_PADDING;
+
+	int x0, y0, x1, y1;
+	stbtt_GetCodepointBox(&info, 'H', &x0, &y0, &x1, &y1);
+	fontCapHeight = y1 * scale;
+
+	BakedGlyph baked[FONT_CHAR_COUNT];
+	int shelfX = FONT_ATLAS_SPACING, shelfY = FONT_ATLAS_SPACING, shelfHeight = 0;
+	for (int i = 0; i < FONT_CHAR_COUNT; i++) {
+		int codepoint = FONT_FIRST_CHAR + i;
+		int advance, leftBearing, xoff = 0, yoff = 0;
+		stbtt_GetCodepointHMetrics(&info, codepoint, &advance, &leftBearing);
+		BakedGlyph* glyph = &baked[i];
+		glyph->width = glyph->height = 0;
+		// 空白など輪郭のない文字は NULL（送り幅だけ使う）
+		glyph->sdf = stbtt_GetCodepointSDF(&info, scale, codepoint, FONT_SDF_PADDING, FONT_SDF_ONEDGE, distScale,
+		                                   &glyph->width, &glyph->height, &xoff, &yoff);
+		if (glyph->sdf && shelfX + glyph->width + FONT_ATLAS_SPACING > FONT_ATLAS_WIDTH) {
+			shelfX = FONT_ATLAS_SPACING;
+			shelfY += shelfHeight + FONT_ATLAS_SPACING;
+			shelfHeight = 0;
+		}
+		glyph->x = shelfX;
+		glyph->y = shelfY;
+		if (glyph->sdf) {
+			shelfX += glyph->width + FONT_ATLAS_SPACING;
+			if (glyph->height > shelfHeight) shelfHeight = glyph->height;
+		}
+
+		// stb の yoff は上端（下向き）なので上向きに直す
+		FontGlyph* metrics = &fontGlyphs[i];
+		metrics->x1 = (float)xoff;
+		metrics->x2 = (float)(xoff + glyph->width);
+		metrics->y2 = (float)-yoff;
+		metrics->y1 = (float)(-yoff - glyph->height);
+		metrics->advance = advance * scale;
+	}
+
+	*atlasHeight = 1;
+	while (*atlasHeight < shelfY + shelfHeight + FONT_ATLAS_SPACING) *atlasHeight *= 2;
+	pixels->assign((size_t)FONT_ATLAS_WIDTH * *atlasHeight, 0);
+	for (int i = 0; i < FONT_CHAR_COUNT; i++) {
+		BakedGlyph* glyph = &baked[i];
+		FontGlyph* metrics = &fontGlyphs[i];
+		metrics->u1 = (float)glyph->x / FONT_ATLAS_WIDTH;
+		metrics->v1 = (float)glyph->y / *atlasHeight;
+		metrics->u2 = (float)(glyph->x + glyph->width) / FONT_ATLAS_WIDTH;
+		metrics->v2 = (float)(glyph->y + glyph->height) / *atlasHeight;
+		if (!glyph->sdf) continue;
+		// ほかのテクスチャと同じく下の行から並べる
+		for (int row = 0; row < glyph->height; row++) {
+			memcpy(&(*pixels)[(size_t)(glyph->y + glyph->height - 1 - row) * FONT_ATLAS_WIDTH + glyph->x],
+			       glyph->sdf + (size_t)row * glyph->width, glyph->width);
+		}
+		stbtt_FreeSDF(glyph->sdf, NULL);
+	}
+	return true;
+}
+
+// TTFがあるときはその大きさとハッシュが一致するキャッシュだけ使う。TTFがなければ形式と設定が合えば使う
+static bool loadFontCache(bool haveTtf, uint32_t ttfSize, uint64_t ttfHash, std::vector<unsigned char>* pixels,
+                          int* atlasHeight)
+{
+	FILE* fp = fopen(FONT_CACHE_PATH, "rb");
+	if (!fp) return false;
+
+	unsigned char header[FONT_CACHE_HEADER_SIZE];
+	unsigned char record[FONT_CHAR_COUNT * FONT_GLYPH_FLOATS * 4];
+	bool ok = fread(header, 1, sizeof(header), fp) == sizeof(header) &&
+	          memcmp(header, kFontCacheMagic, 4) == 0 && getU32(header + 4) == FONT_CACHE_VERSION &&
+	          (!haveTtf || (getU32(header + 8) == ttfSize && getU64(header + 12) == ttfHash)) &&
+	          getU32(header + 20) == FONT_BAKE_PIXELS && getU32(header + 24) == FONT_ATLAS_WIDTH &&
+	          getU32(header + 32) == FONT_CHAR_COUNT;
+	int height = ok ? (int)getU32(header + 28) : 0;
+	ok = ok && height > 0 && height <= 4096 && fread(record, 1, sizeof(record), fp) == sizeof(record);
+	if (ok) {
+		pixels->resize((size_t)FONT_ATLAS_WIDTH * height);
+		ok = fread(pixels->data(), 1, pixels->size(), fp) == pixels->size();
+	}
+	fclose(fp);
+	if (!ok) return false;
+
+	// 大文字の高さで割って表示の大きさを決めるので、0や非数の入ったキャッシュは使わない
+	float capHeight = getF32(header + 36);
+	if (!std::isfinite(capHeight) || capHeight <= 0.0f) return false;
+	FontGlyph glyphs[FONT_CHAR_COUNT];
+	for (int i = 0; i < FONT_CHAR_COUNT; i++) {
+		const unsigned char* p = record + i * FONT_GLYPH_FLOATS * 4;
+		FontGlyph* glyph = &glyphs[i];
+		float* fields[FONT_GLYPH_FLOATS] = {&glyph->u1, &glyph->v1, &glyph->u2, &glyph->v2,
+		                                    &glyph->x1, &glyph->y1, &glyph->x2, &glyph->y2, &glyph->advance};
+		for (int j = 0; j < FONT_GLYPH_FLOATS; j++) {
+			*fields[j] = getF32(p + j * 4);
+			if (!std::isfinite(*fields[j])) return false;
+		}
+	}
+	*atlasHeight = height;
+	fontCapHeight = capHeight;
+	memcpy(fontGlyphs, glyphs, sizeof(fontGlyphs));
+	return true;
+}
+
+static bool saveFontCache(uint32_t ttfSize, uint64_t ttfHash, const std::vector<unsigned char>& pixels, int atlasHeight)
+{
+	FILE* fp = fopen(FONT_CACHE_PATH, "wb");
+	if (!fp) return false;
+
+	unsigned char header[FONT_CACHE_HEADER_SIZE];
+	memcpy(header, kFontCacheMagic, 4);
+	putU32(header + 4, FONT_CACHE_VERSION);
+	putU32(header + 8, ttfSize);
+	putU64(header + 12, ttfHash);
+	putU32(header + 20, FONT_BAKE_PIXELS);
+	putU32(header + 24, FONT_ATLAS_WIDTH);
+	putU32(header + 28, (uint32_t)atlasHeight);
+	putU32(header + 32, FONT_CHAR_COUNT);
+	putF32(header + 36, fontCapHeight);
+
+	unsigned char record[FONT_CHAR_COUNT * FONT_GLYPH_FLOATS * 4];
+	for (int i = 0; i < FONT_CHAR_COUNT; i++) {
+		unsigned char* p = record + i * FONT_GLYPH_FLOATS * 4;
+		const FontGlyph* glyph = &fontGlyphs[i];
+		const float fields[FONT_GLYPH_FLOATS] = {glyph->u1, glyph->v1, glyph->u2, glyph->v2,
+		                                         glyph->x1, glyph->y1, glyph->x2, glyph->y2, glyph->advance};
+		for (int j = 0; j < FONT_GLYPH_FLOATS; j++) putF32(p + j * 4, fields[j]);
+	}
+	bool ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header) &&
+	          fwrite(record, 1, sizeof(record), fp) == sizeof(record) &&
+	          fwrite(pixels.data(), 1, pixels.size(), fp) == pixels.size();
+	return fclose(fp) == 0 && ok;
+}
+
+// TTFから距離場（SDF）のアトラスを作る。前回焼いたものが同じTTFのものならキャッシュから読むだけ
+// TTFがなくてもキャッシュがあればそれを使う。どちらも使えなければ fontLoaded = false のまま（8x8のビットマップで描く）
+void setupFont()
+{
+	cleanupFont();
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<unsigned char> ttf;
+	bool haveTtf = readFile(FONT_TTF_PATH, &ttf);
+	uint32_t ttfSize = haveTtf ? (uint32_t)ttf.size() : 0;
+	uint64_t ttfHash = haveTtf ? hashBytes(ttf) : 0;
+
+	std::vector<unsigned char> pixels;
+	int atlasHeight = 0;
+	bool cached = loadFontCache(haveTtf, ttfSize, ttfHash, &pixels, &atlasHeight);
+	if (!cached) {
+		if (!haveTtf) {
+			printf("フォント読み込み失敗: %s（ビットマップ文字で表示します）\n", FONT_TTF_PATH);
+			return;
+		}
+		if (!bakeFont(ttf, &pixels, &atlasHeight)) {
+			printf("フォントを解析できません: %s（ビットマップ文字で表示します）\n", FONT_TTF_PATH);
+			return;
+		}
+		if (!saveFontCache(ttfSize, ttfHash, pixels, atlasHeight)) {
+			printf("フォントのキャッシュを書き込めません: %s\n", FONT_CACHE_PATH);
+		}
+	}
+
+	// 距離場は線形補間して輪郭をシェーダで切るので、拡大しても縁がぼやけない
+	glGenTextures(1, &fontTexture);
+	bindTexture2D(fontTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, FONT_ATLAS_WIDTH, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	fontLoaded = true;
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	printf("フォント: %s %dx%d (%s, %.1fms)\n", cached ? FONT_CACHE_PATH : FONT_TTF_PATH, FONT_ATLAS_WIDTH,
+	       atlasHeight, cached ? (haveTtf ? "キャッシュ" : "キャッシュ、TTFなし") : "焼き込み", ms);
+}
+
+void cleanupFont()
+{
+	if (fontTexture != 0) glDeleteTextures(1, &fontTexture);
+	fontTexture = 0;
+	fontLoaded = false;
+	resetGlStateCache();
+}
@@ -1,125 +1,217 @@
 #include "renderer.h"
+#include "analysis.h"
 
-unsigned int gameVAO, gameVBO;
+// セルとアイコンは単位四角形をセル数だけインスタンス描画し（1セル1バイト）、
+// 格子線は色付き三角形の頂点列にまとめて、それぞれ1回の描画で出す
+// 格子線と単位四角形は setupGameRenderer で一度だけ転送し、セルのデータは局面が変わったときだけ送る
+#define BOARD_SCALE 0.7f       // ボードを画面の70%サイズに
+#define BOARD_CELL_COUNT (BOARD_SIZE * BOARD_SIZE)
+#define BOARD_LINE_COUNT (2 * (BOARD_SIZE + 1))
 
-void setupGameRenderer()
+static unsigned int gridVAO, gridVBO;
+static unsigned int cellVAO, cellQuadVBO, cellInstanceVBO;
+static float gridVertices[BOARD_LINE_COUNT * 6 * VERTEX_COLOR_FLOATS];
+static int gridVertexCount = 0;
+static uint8_t cellInstances[BOARD_CELL_COUNT];   // 値の符号 | (列の状態 << 2)、cellFragmentShaderSource 参照
+static bool cellInstancesDirty = true;            // 次のフレームで必ず送る
+static uint32_t cellInstancesRevision = 0;        // 送ったセルの GameState::revision
+
+// 解析オーバーレイ（列ごとの勝率表示）
+static bool analysisOverlayEnabled = false;
+
+void setAnalysisOverlay(bool enabled)
 {
-	glGenVertexArrays(1, &gameVAO);
-	glGenBuffers(1, &gameVBO);
-	
-	// テクスチャ用VAO/VBOの設定
-	glGenVertexArrays(1, &textureVAO);
-	glGenBuffers(1, &textureVBO);
+	if (enabled == analysisOverlayEnabled) return;
+	analysisOverlayEnabled = enabled;
+	// 表示しない間は解析スレッドも止めておく
+	if (enabled) {
+		startAnalysis();
+	} else {
+		stopAnalysis();
+	}
 }
 
-void cleanupGameRenderer()
+bool isAnalysisOverlayEnabled()
 {
-	glDeleteVertexArrays(1, &gameVAO);
-	glDeleteBuffers(1, &gameVBO);
-	glDeleteVertexArrays(1, &textureVAO);
-	glDeleteBuffers(1, &textureVBO);
+	return analysisOverlayEnabled;
 }
 
-void renderGame()
+static void renderAnalysisOverlay(GameState* game, float startX, float startY, float cellSize)
 {
-	GameState* game = getGameState();
+	// 取得できなかったフレームは前回の結果をそのまま使う（描画を待たせない）
+	static AnalysisSnapshot snapshot;
+	static bool hasSnapshot = false;
 	
-	// ボードの描画（平面表示、画面の70%サイズ）
-	float boardScale = 0.7f;  // ボードを画面の70%サイズに
-	float cellSize = (2.0f * boardScale) / BOARD_SIZE;  
-	float startX = -boardScale;
-	float startY = boardScale;
-	
-	glUseProgram(shaderProgram);
-	glBindVertexArray(gameVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, gameVBO);
+	requestAnalysis(game);
+	if (getAnalysisSnapshot(&snapshot)) {
+		hasSnapshot = true;
+	}
+	if (!hasSnapshot || snapshot.revision != game->revision || game->gameOver) return;
 	
-	// 各セルを描画
-	for (int row = 0; row < BOARD_SIZE; row++) {
-		float y1 = startY - row * cellSize;
-		float y2 = y1 - cellSize;
+	float textScale = 0.05f;
+	float textColor[3] = {1.0f, 1.0f, 0.6f};
+	beginTextBatch();
+	for (int col = 0; col < BOARD_SIZE; col++) {
+		if (snapshot.samples[col] == 0) continue;
 		
+		// 手番側がこの列を選んだときの勝率（%）を列の上に中央揃えで表示
+		char text[8];
+		int percent = (int)(snapshot.winRate[col] * 100.0f + 0.5f);
+		sprintf(text, "%d", percent);
+		float textWidth = measureText(text, textScale);
+		float x = startX + col * cellSize + (cellSize - textWidth) / 2.0f;
+		renderText(text, x, startY + 0.02f, textScale, textColor);
+	}
+	endTextBatch();
+}
+
+// 四角形（三角形2枚）の頂点を書き、書いた float の数を返す
+static int putColorQuad(float* out, float x1, float y1, float x2, float y2, const float color[3])
+{
+	const float corners[6][2] = {{x1, y1}, {x2, y1}, {x2, y2}, {x1, y1}, {x2, y2}, {x1, y2}};
+	for (int i = 0; i < 6; i++) {
+		float* v = out + i * VERTEX_COLOR_FLOATS;
+		v[0] = corners[i][0]; v[1] = corners[i][1]; v[2] = 0.0f;
+		v[3] = color[0]; v[4] = color[1]; v[5] = color[2];
+	}
+	return 6 * VERTEX_COLOR_FLOATS;
+}
+
+// セル1個分のインスタンスデータ（値の符号: 0 = 無効, 1 = +1, 2 = +2, 3 = -1）
+static uint8_t encodeCell(CellValue value, ColumnState state)
+{
+	uint8_t code = 0;
+	if (value == PLUS_ONE) code = 1;
+	else if (value == PLUS_TWO) code = 2;
+	else if (value == MINUS_ONE) code = 3;
+	return (uint8_t)(code | (state << 2));
+}
+
+// セルのインスタンスデータを詰める
+static void buildCellInstances(const GameState* game)
+{
+	for (int row = 0; row < BOARD_SIZE; row++) {
 		for (int col = 0; col < BOARD_SIZE; col++) {
-			float x1 = startX + col * cellSize;
-			float x2 = x1 + cellSize;
-			
-			// 列の背景色を決定
-			float bgColor[3] = {0.8f, 0.8f, 0.8f};  // デフォルト（グレー）
-			if (game->columnStates[col] == PAINTED_RED) {
-				bgColor[0] = 1.0f; bgColor[1] = 0.3f; bgColor[2] = 0.3f;  // 赤
-			} else if (game->columnStates[col] == PAINTED_BLUE) {
-				bgColor[0] = 0.3f; bgColor[1] = 0.3f; bgColor[2] = 1.0f;  // 青
-			}
-			
-			// セルの色を決定（全て背景色ベース）
-			float cellColor[3] = {bgColor[0], bgColor[1], bgColor[2]};
-			
-			// +1/-1マスも無効マスも同じ背景色を使用
-			
-			// 四角形の頂点データ
-			float vertices[] = {
-				// 位置           // 色
-				x1, y1, 0.0f,    cellColor[0], cellColor[1], cellColor[2],
-				x2, y1, 0.0f,    cellColor[0], cellColor[1], cellColor[2],
-				x2, y2, 0.0f,    cellColor[0], cellColor[1], cellColor[2],
-				x1, y1, 0.0f,    cellColor[0], cellColor[1], cellColor[2],
-				x2, y2, 0.0f,    cellColor[0], cellColor[1], cellColor[2],
-				x1, y2, 0.0f,    cellColor[0], cellColor[1], cellColor[2]
-			};
-			
-			glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-			
-			// 頂点属性の設定
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-			glEnableVertexAttribArray(0);
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-			glEnableVertexAttribArray(1);
-			
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-			
-			// テクスチャの描画（+1/+2/-1マスの場合、テクスチャが有効な場合のみ）
-			if (game->board[row][col] == PLUS_ONE && plusOneTexture != 0) {
-				renderTexture(plusOneTexture, x1, y1, x2, y2);
-			} else if (game->board[row][col] == PLUS_TWO && plusTwoTexture != 0) {
-				renderTexture(plusTwoTexture, x1, y1, x2, y2);
-			} else if (game->board[row][col] == MINUS_ONE && minusOneTexture != 0) {
-				renderTexture(minusOneTexture, x1, y1, x2, y2);
-			}
+			cellInstances[row * BOARD_SIZE + col] = encodeCell(game->board[row][col], game->columnStates[col]);
 		}
 	}
-	
-	// グリッド線の描画（黒い線）
+}
+
+// 格子線（黒い線）を1ピクセル幅の四角形にして頂点を組み立て、頂点数を返す
+// アイコン画像の縁は透明なので、セルの後に描いても先に描いても線は隠れない
+static int buildGridVertices(float startX, float startY, float cellSize)
+{
+	float* color = gridVertices;
 	float gridColor[3] = {0.1f, 0.1f, 0.1f};
-	
-	// 横線
+	float halfWidth = 1.0f / WINDOW_WIDTH;
+	float halfHeight = 1.0f / WINDOW_HEIGHT;
+	float endX = startX + BOARD_SIZE * cellSize;
+	float endY = startY - BOARD_SIZE * cellSize;
 	for (int row = 0; row <= BOARD_SIZE; row++) {
 		float y = startY - row * cellSize;
-		float line[] = {
-			startX, y, 0.0f, gridColor[0], gridColor[1], gridColor[2],
-			startX + BOARD_SIZE * cellSize, y, 0.0f, gridColor[0], gridColor[1], gridColor[2]
-		};
-		glBufferData(GL_ARRAY_BUFFER, sizeof(line), line, GL_DYNAMIC_DRAW);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-		glEnableVertexAttribArray(1);
-		glDrawArrays(GL_LINES, 0, 2);
+		color += putColorQuad(color, startX, y + halfHeight, endX, y - halfHeight, gridColor);
 	}
-	
-	// 縦線
 	for (int col = 0; col <= BOARD_SIZE; col++) {
 		float x = startX + col * cellSize;
-		float line[] = {
-			x, startY, 0.0f, gridColor[0], gridColor[1], gridColor[2],
-			x, startY - BOARD_SIZE * cellSize, 0.0f, gridColor[0], gridColor[1], gridColor[2]
-		};
-		glBufferData(GL_ARRAY_BUFFER, sizeof(line), line, GL_DYNAMIC_DRAW);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-		glEnableVertexAttribArray(1);
-		glDrawArrays(GL_LINES, 0, 2);
+		color += putColorQuad(color, x - halfWidth, startY, x + halfWidth, endY, gridColor);
 	}
+	return (int)(color - gridVertices) / VERTEX_COLOR_FLOATS;
+}
+
+void setupGameRenderer()
+{
+	// オーバーレイ・画像の動的な頂点バッファと、文字のインスタンス描画
+	setupVertexFormats();
+	setupTextRenderer();
+	
+	// 格子線（位置は変わらないので頂点ごと一度だけ転送する）
+	gridVertexCount = buildGridVertices(-BOARD_SCALE, BOARD_SCALE, (2.0f * BOARD_SCALE) / BOARD_SIZE);
+	glGenVertexArrays(1, &gridVAO);
+	glGenBuffers(1, &gridVBO);
+	bindVertexArray(gridVAO);
+	bindArrayBuffer(gridVBO);
+	glBufferData(GL_ARRAY_BUFFER, gridVertexCount * VERTEX_COLOR_FLOATS * sizeof(float), gridVertices, GL_STATIC_DRAW);
+	configureVertexFormat(VERTEX_FORMAT_COLOR);
+	
+	// セル: 属性0は単位四角形の角（全インスタンス共通）、属性1はセルごとの1バイト
+	static const float cellCorners[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+	glGenVertexArrays(1, &cellVAO);
+	glGenBuffers(1, &cellQuadVBO);
+	glGenBuffers(1, &cellInstanceVBO);
+	bindVertexArray(cellVAO);
+	bindArrayBuffer(cellQuadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cellCorners), cellCorners, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	bindArrayBuffer(cellInstanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cellInstances), NULL, GL_DYNAMIC_DRAW);
+	glVertexAttribIPointer(1, 1, GL_UNSIGNED_BYTE, sizeof(uint8_t), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+	bindVertexArray(0);
+	cellInstancesDirty = true;
+	
+	// 盤面の位置とアイコンのアトラス内の範囲は変わらないので一度だけ設定する
+	// （Sprite の順は値の符号 - 1 と同じ。画像が読めなかったアイコンは描かない）
+	float regions[SPRITE_COUNT * 4];
+	int iconMask = 0;
+	for (int i = 0; i < SPRITE_COUNT; i++) {
+		const AtlasRegion* region = &atlasRegions[i];
+		regions[i * 4 + 0] = region->u1;
+		regions[i * 4 + 1] = region->v1;
+		regions[i * 4 + 2] = region->u2;
+		regions[i * 4 + 3] = region->v2;
+		if (region->loaded) iconMask |= 1 << i;
+	}
+	useProgram(cellShaderProgram);
+	glUniform2f(glGetUniformLocation(cellShaderProgram, "boardOrigin"), -BOARD_SCALE, BOARD_SCALE);
+	glUniform1f(glGetUniformLocation(cellShaderProgram, "cellSize"), (2.0f * BOARD_SCALE) / BOARD_SIZE);
+	glUniform1i(glGetUniformLocation(cellShaderProgram, "boardSize"), BOARD_SIZE);
+	glUniform1i(glGetUniformLocation(cellShaderProgram, "iconAtlas"), 0);
+	glUniform4fv(glGetUniformLocation(cellShaderProgram, "iconRegions"), SPRITE_COUNT, regions);
+	glUniform1i(glGetUniformLocation(cellShaderProgram, "iconMask"), iconMask);
+}
+
+void cleanupGameRenderer()
+{
+	cleanupVertexFormats();
+	cleanupTextRenderer();
+	glDeleteVertexArrays(1, &gridVAO);
+	glDeleteBuffers(1, &gridVBO);
+	glDeleteVertexArrays(1, &cellVAO);
+	glDeleteBuffers(1, &cellQuadVBO);
+	glDeleteBuffers(1, &cellInstanceVBO);
+	resetGlStateCache();  // 削除したオブジェクトの結合は GL 側で外れる
+	setAnalysisOverlay(false);
+}
+
+void renderGame()
+{
+	GameState* game = getGameState();
+	
+	// ボードの描画（平面表示、画面の70%サイズ）
+	float cellSize = (2.0f * BOARD_SCALE) / BOARD_SIZE;
+	float startX = -BOARD_SCALE;
+	float startY = BOARD_SCALE;
+	
+	// セルとアイコン: 盤面か列の状態が変わったとき（revision が進んだとき）だけ36バイトを送る
+	useProgram(cellShaderProgram);
+	bindVertexArray(cellVAO);
+	if (cellInstancesDirty || cellInstancesRevision != game->revision) {
+		buildCellInstances(game);
+		bindArrayBuffer(cellInstanceVBO);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(cellInstances), cellInstances);
+		cellInstancesRevision = game->revision;
+		cellInstancesDirty = false;
+	}
+	bindTexture2D(atlasTexture);
+	setBlend(false);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, BOARD_CELL_COUNT);
+	
+	// 格子線（転送済み）
+	useProgram(shaderProgram);
+	bindVertexArray(gridVAO);
+	glDrawArrays(GL_TRIANGLES, 0, gridVertexCount);
 	
 	// ゲーム終了時のみコンソール出力（一度だけ）
 	static bool gameEndOutputShown = false;
@@ -177,6 +269,11 @@ void renderGame()
 	// スコア表示
 	renderScore(game->redScore, game->blueScore);
 	
+	// 勝率オーバーレイ
+	if (analysisOverlayEnabled) {
+		renderAnalysisOverlay(game, startX, startY, cellSize);
+	}
+	
 	// +2変化演出の処理
 	if (game->effectState != NO_EFFECT) {
 		double currentTime = glfwGetTime();
@@ -203,28 +300,17 @@ void renderGame()
 					-1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 0.0f
 				};
 				
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				setBlend(true);
 				
-				glUseProgram(shaderProgram);
-				glBindVertexArray(gameVAO);
-				glBindBuffer(GL_ARRAY_BUFFER, gameVBO);
-				glBufferData(GL_ARRAY_BUFFER, sizeof(overlay), overlay, GL_DYNAMIC_DRAW);
-				glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-				glEnableVertexAttribArray(0);
-				glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-				glEnableVertexAttribArray(1);
-				glDrawArrays(GL_TRIANGLES, 0, 6);
-				glDisable(GL_BLEND);
+				useProgram(shaderProgram);
+				drawVertices(VERTEX_FORMAT_COLOR, overlay, 6);
 				
 				// 暗転中は"+2"テキストを中央に大きく表示
 				float textColor[3] = {1.0f, 1.0f, 0.0f}; // 黄色
 				float textScale = 0.5f; // 大きなサイズ
 				
 				// "+2"の文字幅を計算して中央に配置
-				// +文字 + 2文字 = 約2文字分の幅
-				float totalWidth = textScale * 1.0f + textScale * 1.2f; // +の幅 + 2の幅
-				float centerX = -totalWidth / 2.0f;
+				float centerX = -measureText("+2", textScale) / 2.0f;
 				
 				renderText("+2", centerX, 0.0f, textScale, textColor);
 			} else {
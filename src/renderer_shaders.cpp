@@ -2,6 +2,9 @@
 
 unsigned int shaderProgram;
 unsigned int textureShaderProgram;
+unsigned int cellShaderProgram;
+unsigned int glyphShaderProgram;
+unsigned int fontShaderProgram;
 
 // 頂点シェーダのソース
 const char* vertexShaderSource = R"(
@@ -61,6 +64,167 @@ void main()
 }
 )";
 
+// 盤面のセルをインスタンス描画するシェーダ
+// 単位四角形（aCorner）をセルの数だけ描き、インスタンスごとの1バイト（下位2bit = マスの値、
+// 次の2bit = 列の状態）から色とアイコンを決める。セルの位置は gl_InstanceID から求める
+const char* cellVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in uint aCell;
+
+uniform vec2 boardOrigin;   // 左上の角
+uniform float cellSize;
+uniform int boardSize;
+
+out vec2 TexCoord;
+flat out int Value;
+flat out int ColumnState;
+
+void main()
+{
+	int col = gl_InstanceID % boardSize;
+	int row = gl_InstanceID / boardSize;
+	vec2 pos = boardOrigin + vec2(col + aCorner.x, -(row + aCorner.y)) * cellSize;
+	gl_Position = vec4(pos, 0.0, 1.0);
+	TexCoord = vec2(aCorner.x, 1.0 - aCorner.y);
+	Value = int(aCell & 3u);
+	ColumnState = int((aCell >> 2) & 3u);
+}
+)";
+
+const char* cellFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in int Value;          // 0 = 無効, 1 = +1, 2 = +2, 3 = -1
+flat in int ColumnState;    // 0 = 未塗装, 1 = 赤, 2 = 青
+uniform sampler2D iconAtlas;
+uniform vec4 iconRegions[3];   // Value - 1 ごとのアトラス内の範囲（左下 xy, 右上 zw）
+uniform int iconMask;          // 読み込めたアイコン（bit0 = +1, bit1 = +2, bit2 = -1）
+
+void main()
+{
+	vec3 color = vec3(0.8, 0.8, 0.8);
+	if (ColumnState == 1) color = vec3(1.0, 0.3, 0.3);
+	if (ColumnState == 2) color = vec3(0.3, 0.3, 1.0);
+
+	vec4 region = iconRegions[max(Value - 1, 0)];
+	vec4 icon = texture(iconAtlas, mix(region.xy, region.zw, TexCoord));
+	bool hasIcon = Value != 0 && (iconMask & (1 << (Value - 1))) != 0;
+
+	// 元のアイコン描画と同じく、不透明度0.1未満は捨ててアルファで重ねる
+	if (hasIcon && icon.a >= 0.1)
+		color = mix(color, icon.rgb, icon.a);
+	FragColor = vec4(color, 1.0);
+}
+)";
+
+// 文字をインスタンス描画するシェーダ
+// 1文字 = 単位四角形1つ。インスタンスごとの64bitのマスクから点灯する画素（8x8）か
+// 7セグメントの棒を判定する。マスクの作り方は renderer_text.cpp を参照
+const char* glyphVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec3 aOrigin;   // 左下の xy と大きさ
+layout (location = 2) in vec3 aColor;
+layout (location = 3) in uvec2 aMask;
+layout (location = 4) in uint aKind;     // 0 = 8x8ビットマップ, 1 = 7セグメント
+
+out vec2 Local;
+out vec3 GlyphColor;
+flat out uvec2 Mask;
+flat out uint Kind;
+
+void main()
+{
+	// 7セグメントの数字は幅0.6、ビットマップは正方形
+	float width = aKind == 1u ? 0.6 : 1.0;
+	Local = aCorner * vec2(width, 1.0);
+	gl_Position = vec4(aOrigin.xy + Local * aOrigin.z, 0.0, 1.0);
+	GlyphColor = aColor;
+	Mask = aMask;
+	Kind = aKind;
+}
+)";
+
+const char* glyphFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 Local;
+in vec3 GlyphColor;
+flat in uvec2 Mask;
+flat in uint Kind;
+
+// 上・右上・右下・下・左下・左上・中央（左下 xy, 右上 zw）
+const vec4 segments[7] = vec4[7](
+	vec4(0.0, 0.92, 0.6, 1.0), vec4(0.52, 0.5, 0.6, 1.0), vec4(0.52, 0.0, 0.6, 0.5),
+	vec4(0.0, 0.0, 0.6, 0.08), vec4(0.0, 0.0, 0.08, 0.5), vec4(0.0, 0.5, 0.08, 1.0),
+	vec4(0.0, 0.42, 0.6, 0.5));
+
+void main()
+{
+	bool lit = false;
+	if (Kind == 0u) {
+		// 行0が上
+		ivec2 cell = clamp(ivec2(Local * 8.0), 0, 7);
+		int index = (7 - cell.y) * 8 + cell.x;
+		uint word = index < 32 ? Mask.x : Mask.y;
+		lit = ((word >> uint(index & 31)) & 1u) != 0u;
+	} else {
+		for (int i = 0; i < 7; i++) {
+			vec4 s = segments[i];
+			if ((Mask.x & (1u << uint(i))) != 0u &&
+			    all(greaterThanEqual(Local, s.xy)) && all(lessThanEqual(Local, s.zw)))
+				lit = true;
+		}
+	}
+	if (!lit)
+		discard;
+	FragColor = vec4(GlyphColor, 1.0);
+}
+)";
+
+// フォントの距離場をインスタンス描画するシェーダ
+// 距離場の値 0.5 が輪郭。画面上の1画素分の変化量（fwidth）で縁をぼかすので、どの大きさでも縁の幅は約1画素
+const char* fontVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec4 aRect;     // 左下 xy, 右上 zw
+layout (location = 2) in vec4 aUV;
+layout (location = 3) in vec3 aColor;
+
+out vec2 TexCoord;
+out vec3 TextColor;
+
+void main()
+{
+	gl_Position = vec4(mix(aRect.xy, aRect.zw, aCorner), 0.0, 1.0);
+	TexCoord = mix(aUV.xy, aUV.zw, aCorner);
+	TextColor = aColor;
+}
+)";
+
+const char* fontFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec3 TextColor;
+uniform sampler2D fontAtlas;
+
+void main()
+{
+	float distance = texture(fontAtlas, TexCoord).r;
+	float edge = max(fwidth(distance) * 0.7, 1e-4);
+	float alpha = smoothstep(0.5 - edge, 0.5 + edge, distance);
+	if (alpha <= 0.0)
+		discard;
+	FragColor = vec4(TextColor, alpha);
+}
+)";
+
 unsigned int compileShader(unsigned int type, const char* source)
 {
 	unsigned int shader = glCreateShader(type);
@@ -123,16 +287,74 @@ void setupShaders()
 	glDeleteShader(textureVertexShader);
 	glDeleteShader(textureFragmentShader);
 	
-	// テクスチャを初期化
-	setupTextures();
+	// セルのシェーダー（uniform の設定は setupGameRenderer で行う）
+	unsigned int cellVertexShader = compileShader(GL_VERTEX_SHADER, cellVertexShaderSource);
+	unsigned int cellFragmentShader = compileShader(GL_FRAGMENT_SHADER, cellFragmentShaderSource);
+
+	cellShaderProgram = glCreateProgram();
+	glAttachShader(cellShaderProgram, cellVertexShader);
+	glAttachShader(cellShaderProgram, cellFragmentShader);
+	glLinkProgram(cellShaderProgram);
+
+	glGetProgramiv(cellShaderProgram, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(cellShaderProgram, 512, NULL, infoLog);
+		std::cerr << "Cell shader linking error:\n" << infoLog << std::endl;
+	}
+
+	glDeleteShader(cellVertexShader);
+	glDeleteShader(cellFragmentShader);
 	
-	// テキストレンダラーを初期化
-	setupTextRenderer();
+	// 文字のシェーダー
+	unsigned int glyphVertexShader = compileShader(GL_VERTEX_SHADER, glyphVertexShaderSource);
+	unsigned int glyphFragmentShader = compileShader(GL_FRAGMENT_SHADER, glyphFragmentShaderSource);
+
+	glyphShaderProgram = glCreateProgram();
+	glAttachShader(glyphShaderProgram, glyphVertexShader);
+	glAttachShader(glyphShaderProgram, glyphFragmentShader);
+	glLinkProgram(glyphShaderProgram);
+
+	glGetProgramiv(glyphShaderProgram, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(glyphShaderProgram, 512, NULL, infoLog);
+		std::cerr << "Glyph shader linking error:\n" << infoLog << std::endl;
+	}
+
+	glDeleteShader(glyphVertexShader);
+	glDeleteShader(glyphFragmentShader);
+	
+	// フォントのシェーダー（サンプラーの設定は setupTextRenderer で行う）
+	unsigned int fontVertexShader = compileShader(GL_VERTEX_SHADER, fontVertexShaderSource);
+	unsigned int fontFragmentShader = compileShader(GL_FRAGMENT_SHADER, fontFragmentShaderSource);
+
+	fontShaderProgram = glCreateProgram();
+	glAttachShader(fontShaderProgram, fontVertexShader);
+	glAttachShader(fontShaderProgram, fontFragmentShader);
+	glLinkProgram(fontShaderProgram);
+
+	glGetProgramiv(fontShaderProgram, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(fontShaderProgram, 512, NULL, infoLog);
+		std::cerr << "Font shader linking error:\n" << infoLog << std::endl;
+	}
+
+	glDeleteShader(fontVertexShader);
+	glDeleteShader(fontFragmentShader);
+	
+	// テクスチャとフォントを初期化
+	setupTextures();
+	setupFont();
 }
 
 void cleanupShaders()
 {
 	glDeleteProgram(shaderProgram);
 	glDeleteProgram(textureShaderProgram);
-	cleanupTextRenderer();
+	glDeleteProgram(cellShaderProgram);
+	glDeleteProgram(glyphShaderProgram);
+	glDeleteProgram(fontShaderProgram);
+	resetGlStateCache();
 }
\ No newline at end of file
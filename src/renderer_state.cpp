@@ -0,0 +1,86 @@
+#include "renderer.h"
+
+// GL状態のキャッシュ
+// 描画側が最後に設定した値を覚えておき、同じ値の設定は GL を呼ばずに数えるだけにする
+// （glGet* で現在の値を問い合わせるとドライバが同期することがあるので、問い合わせもここで済ませる）
+#define GL_STATE_UNKNOWN 0xFFFFFFFFu
+
+static unsigned int currentProgram = GL_STATE_UNKNOWN;
+static unsigned int currentVertexArray = GL_STATE_UNKNOWN;
+static unsigned int currentArrayBuffer = GL_STATE_UNKNOWN;
+static unsigned int currentTexture = GL_STATE_UNKNOWN;   // ユニット0の GL_TEXTURE_2D
+static int currentBlend = -1;                            // -1 = 不明, 0 = 無効, 1 = 有効
+static bool blendFuncSet = false;
+static GlStateStats glStateStats;
+
+void resetGlStateCache()
+{
+	currentProgram = GL_STATE_UNKNOWN;
+	currentVertexArray = GL_STATE_UNKNOWN;
+	currentArrayBuffer = GL_STATE_UNKNOWN;
+	currentTexture = GL_STATE_UNKNOWN;
+	currentBlend = -1;
+	blendFuncSet = false;
+}
+
+const GlStateStats* getGlStateStats()
+{
+	return &glStateStats;
+}
+
+// 値が変わるときだけ true を返して覚える
+static bool changeState(unsigned int* current, unsigned int value)
+{
+	if (*current == value) {
+		glStateStats.elided++;
+		return false;
+	}
+	*current = value;
+	glStateStats.issued++;
+	return true;
+}
+
+void useProgram(unsigned int program)
+{
+	if (changeState(&currentProgram, program)) glUseProgram(program);
+}
+
+unsigned int getCurrentProgram()
+{
+	return currentProgram == GL_STATE_UNKNOWN ? 0 : currentProgram;
+}
+
+void bindVertexArray(unsigned int vao)
+{
+	if (changeState(&currentVertexArray, vao)) glBindVertexArray(vao);
+}
+
+void bindArrayBuffer(unsigned int buffer)
+{
+	if (changeState(&currentArrayBuffer, buffer)) glBindBuffer(GL_ARRAY_BUFFER, buffer);
+}
+
+void bindTexture2D(unsigned int texture)
+{
+	if (changeState(&currentTexture, texture)) glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+// 半透明の描画はすべて同じ合成式なので、有効にするときに一度だけ設定する
+void setBlend(bool enabled)
+{
+	if (currentBlend == (enabled ? 1 : 0)) {
+		glStateStats.elided++;
+		return;
+	}
+	currentBlend = enabled ? 1 : 0;
+	glStateStats.issued++;
+	if (!enabled) {
+		glDisable(GL_BLEND);
+		return;
+	}
+	glEnable(GL_BLEND);
+	if (!blendFuncSet) {
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		blendFuncSet = true;
+	}
+}
@@ -1,535 +1,492 @@
 #include "renderer.h"
 
 // テキスト描画用の変数
-unsigned int textVAO, textVBO;
 unsigned int digitTextures[10];  // 0-9の数字テクスチャ
 
-void setupTextRenderer()
+// 文字は1文字1インスタンスの四角形として描き、文字列ごと（beginTextBatch 中はまとめて）1回の描画で出す
+// フォントが読めていれば距離場のアトラスから（fontFragmentShaderSource）、
+// 読めなければ点灯する画素をマスクからシェーダで判定する（glyphFragmentShaderSource）
+#define GLYPH_BITMAP 0u     // 8x8のビットマップ（ビット 行*8+列、行0が上）
+#define GLYPH_SEGMENTS 1u   // 7セグメント（ビット0から 上・右上・右下・下・左下・左上・中央）
+#define TEXT_MAX_GLYPHS 256
+
+typedef struct {
+	float x, y, size;        // 左下と大きさ
+	float color[3];
+	uint32_t mask[2];        // 下位32bit, 上位32bit
+	uint32_t kind;
+} GlyphInstance;
+
+typedef struct {
+	float rect[4];           // 左下と右上
+	float uv[4];
+	float color[3];
+} FontInstance;
+
+static unsigned int glyphVAO, glyphQuadVBO, glyphInstanceVBO;
+static GlyphInstance glyphInstances[TEXT_MAX_GLYPHS];
+static int glyphCount = 0;
+
+static unsigned int fontVAO, fontInstanceVBO;
+static FontInstance fontInstances[TEXT_MAX_GLYPHS];
+static int fontCount = 0;
+
+static int textBatchDepth = 0;
+
+// "#" が点灯する8文字x8行の文字列からビットマスクを作る（コンパイル時に評価）
+static constexpr uint64_t glyphMask(const char* rows)
 {
-	// テキスト描画用のVAO/VBOを設定
-	glGenVertexArrays(1, &textVAO);
-	glGenBuffers(1, &textVBO);
+	uint64_t mask = 0;
+	for (int i = 0; i < 64; i++) {
+		if (rows[i] == '#') mask |= 1ULL << i;
+	}
+	return mask;
 }
 
-void cleanupTextRenderer()
+typedef struct {
+	uint64_t masks[128];
+} GlyphTable;
+
+static constexpr GlyphTable buildGlyphTable()
 {
-	glDeleteVertexArrays(1, &textVAO);
-	glDeleteBuffers(1, &textVBO);
+	GlyphTable t = {};
+	t.masks['R'] = glyphMask("######.."
+	                          "#.....#."
+	                          "#.....#."
+	                          "######.."
+	                          "#..#...."
+	                          "#...#..."
+	                          "#....#.."
+	                          "........");
+	t.masks['E'] = glyphMask("#######."
+	                          "#......."
+	                          "#......."
+	                          "#####..."
+	                          "#......."
+	                          "#......."
+	                          "#######."
+	                          "........");
+	t.masks['D'] = glyphMask("######.."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "######.."
+	                          "........");
+	t.masks['B'] = glyphMask("######.."
+	                          "#.....#."
+	                          "#.....#."
+	                          "######.."
+	                          "#.....#."
+	                          "#.....#."
+	                          "######.."
+	                          "........");
+	t.masks['L'] = glyphMask("#......."
+	                          "#......."
+	                          "#......."
+	                          "#......."
+	                          "#......."
+	                          "#......."
+	                          "#######."
+	                          "........");
+	t.masks['U'] = glyphMask("#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          ".#####.."
+	                          "........");
+	t.masks['W'] = glyphMask("#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#..#..#."
+	                          "#.#.#.#."
+	                          "##...##."
+	                          "#.....#."
+	                          "........");
+	t.masks['I'] = glyphMask(".#####.."
+	                          "...#...."
+	                          "...#...."
+	                          "...#...."
+	                          "...#...."
+	                          "...#...."
+	                          ".#####.."
+	                          "........");
+	t.masks['N'] = glyphMask("#.....#."
+	                          "##....#."
+	                          "#.#...#."
+	                          "#..#..#."
+	                          "#...#.#."
+	                          "#....##."
+	                          "#.....#."
+	                          "........");
+	t.masks['S'] = glyphMask(".#####.."
+	                          "#......."
+	                          "#......."
+	                          ".####..."
+	                          "......#."
+	                          "......#."
+	                          ".#####.."
+	                          "........");
+	t.masks['T'] = glyphMask("#######."
+	                          "...#...."
+	                          "...#...."
+	                          "...#...."
+	                          "...#...."
+	                          "...#...."
+	                          "...#...."
+	                          "........");
+	t.masks['P'] = glyphMask("######.."
+	                          "#.....#."
+	                          "#.....#."
+	                          "######.."
+	                          "#......."
+	                          "#......."
+	                          "#......."
+	                          "........");
+	t.masks['+'] = glyphMask("........"
+	                          "...##..."
+	                          "...##..."
+	                          ".######."
+	                          "...##..."
+	                          "...##..."
+	                          "...##..."
+	                          "........");
+	t.masks['O'] = glyphMask(".#####.."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          ".#####.."
+	                          "........");
+	t.masks['A'] = glyphMask("..###..."
+	                          ".#...#.."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#######."
+	                          "#.....#."
+	                          "#.....#."
+	                          "........");
+	t.masks['C'] = glyphMask(".#####.."
+	                          "#.....#."
+	                          "#......."
+	                          "#......."
+	                          "#......."
+	                          "#.....#."
+	                          ".#####.."
+	                          "........");
+	t.masks['G'] = glyphMask(".#####.."
+	                          "#.....#."
+	                          "#......."
+	                          "#..####."
+	                          "#.....#."
+	                          "#.....#."
+	                          ".#####.."
+	                          "........");
+	t.masks['M'] = glyphMask("#.....#."
+	                          "##...##."
+	                          "#.#.#.#."
+	                          "#..#..#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "........");
+	t.masks['F'] = glyphMask("#######."
+	                          "#......."
+	                          "#......."
+	                          "#####..."
+	                          "#......."
+	                          "#......."
+	                          "#......."
+	                          "........");
+	t.masks['H'] = glyphMask("#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#######."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "........");
+	t.masks['V'] = glyphMask("#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          ".#...#.."
+	                          "..#.#..."
+	                          "...#...."
+	                          "........");
+	t.masks['Y'] = glyphMask("#.....#."
+	                          ".#...#.."
+	                          "..#.#..."
+	                          "...#...."
+	                          "...#...."
+	                          "...#...."
+	                          "...#...."
+	                          "........");
+	t.masks['K'] = glyphMask("#.....#."
+	                          "#....#.."
+	                          "#...#..."
+	                          "#..#...."
+	                          "#.#....."
+	                          "##......"
+	                          "#.#....."
+	                          "#..#....");
+	t.masks['J'] = glyphMask("#######."
+	                          "....#..."
+	                          "....#..."
+	                          "....#..."
+	                          "....#..."
+	                          "#...#..."
+	                          ".###...."
+	                          "........");
+	t.masks['Q'] = glyphMask(".#####.."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#.....#."
+	                          "#..#..#."
+	                          "#...#.#."
+	                          ".######."
+	                          "........");
+	t.masks['X'] = glyphMask("#.....#."
+	                          ".#...#.."
+	                          "..#.#..."
+	                          "...#...."
+	                          "..#.#..."
+	                          ".#...#.."
+	                          "#.....#."
+	                          "........");
+	t.masks['Z'] = glyphMask("#######."
+	                          ".....#.."
+	                          "....#..."
+	                          "...#...."
+	                          "..#....."
+	                          ".#......"
+	                          "#######."
+	                          "........");
+	return t;
 }
 
-void renderDigit(int digit, float x, float y, float size, float color[3])
+static constexpr GlyphTable kGlyphTable = buildGlyphTable();
+
+// 数字の7セグメント（ビット0から 上・右上・右下・下・左下・左上・中央）
+static constexpr uint32_t kDigitSegments[10] = {
+	0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F
+};
+#define SEGMENT_MINUS 0x40u   // 中央のセグメントだけ
+
+void setupTextRenderer()
 {
-	if (digit < 0 || digit > 9) return;
-	
-	// 簡単な7セグメント風の数字描画
-	// 各数字のセグメントパターンを定義
-	bool segments[10][7] = {
-		{1,1,1,1,1,1,0}, // 0
-		{0,1,1,0,0,0,0}, // 1  
-		{1,1,0,1,1,0,1}, // 2
-		{1,1,1,1,0,0,1}, // 3
-		{0,1,1,0,0,1,1}, // 4
-		{1,0,1,1,0,1,1}, // 5
-		{1,0,1,1,1,1,1}, // 6
-		{1,1,1,0,0,0,0}, // 7
-		{1,1,1,1,1,1,1}, // 8
-		{1,1,1,1,0,1,1}  // 9
-	};
-	
-	float segWidth = size * 0.6f;    // セグメント幅を小さく
-	float segHeight = size * 0.08f;  // セグメント高さを調整
-	float vertSegHeight = size * 0.35f;
-	float vertSegWidth = size * 0.08f;
+	// 属性0は単位四角形の角（全インスタンス共通）、属性1以降は文字ごと
+	static const float corners[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+	glGenVertexArrays(1, &glyphVAO);
+	glGenBuffers(1, &glyphQuadVBO);
+	glGenBuffers(1, &glyphInstanceVBO);
+	bindVertexArray(glyphVAO);
+	bindArrayBuffer(glyphQuadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
 	
-	glUseProgram(shaderProgram);
-	glBindVertexArray(gameVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, gameVBO);
+	bindArrayBuffer(glyphInstanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glyphInstances), NULL, GL_STREAM_DRAW);
+	GLsizei stride = sizeof(GlyphInstance);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GlyphInstance, x));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GlyphInstance, color));
+	glVertexAttribIPointer(3, 2, GL_UNSIGNED_INT, stride, (void*)offsetof(GlyphInstance, mask));
+	glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, stride, (void*)offsetof(GlyphInstance, kind));
+	for (int i = 1; i <= 4; i++) {
+		glEnableVertexAttribArray(i);
+		glVertexAttribDivisor(i, 1);
+	}
 	
-	// 7つのセグメントを描画
-	float segPositions[7][4] = {
-		{x, y + size, x + segWidth, y + size - segHeight},           // 上
-		{x + segWidth, y + size, x + segWidth - vertSegWidth, y + size/2}, // 右上
-		{x + segWidth, y + size/2, x + segWidth - vertSegWidth, y},         // 右下
-		{x, y, x + segWidth, y + segHeight},                         // 下
-		{x, y + size/2, x + vertSegWidth, y},                       // 左下
-		{x, y + size, x + vertSegWidth, y + size/2},                // 左上
-		{x, y + size/2, x + segWidth, y + size/2 - segHeight}       // 中央
-	};
+	// フォント: 同じ単位四角形に、文字ごとの四角形・テクスチャ座標・色
+	glGenVertexArrays(1, &fontVAO);
+	glGenBuffers(1, &fontInstanceVBO);
+	bindVertexArray(fontVAO);
+	bindArrayBuffer(glyphQuadVBO);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	bindArrayBuffer(fontInstanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(fontInstances), NULL, GL_STREAM_DRAW);
+	stride = sizeof(FontInstance);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(FontInstance, rect));
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(FontInstance, uv));
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(FontInstance, color));
+	for (int i = 1; i <= 3; i++) {
+		glEnableVertexAttribArray(i);
+		glVertexAttribDivisor(i, 1);
+	}
+	bindVertexArray(0);
 	
-	for (int i = 0; i < 7; i++) {
-		if (segments[digit][i]) {
-			float x1 = segPositions[i][0];
-			float y1 = segPositions[i][1];
-			float x2 = segPositions[i][2];
-			float y2 = segPositions[i][3];
-			
-			float vertices[] = {
-				x1, y1, 0.0f,    color[0], color[1], color[2],
-				x2, y1, 0.0f,    color[0], color[1], color[2],
-				x2, y2, 0.0f,    color[0], color[1], color[2],
-				x1, y1, 0.0f,    color[0], color[1], color[2],
-				x2, y2, 0.0f,    color[0], color[1], color[2],
-				x1, y2, 0.0f,    color[0], color[1], color[2]
-			};
-			
-			glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-			
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-			glEnableVertexAttribArray(0);
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-			glEnableVertexAttribArray(1);
-			
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-		}
+	useProgram(fontShaderProgram);
+	glUniform1i(glGetUniformLocation(fontShaderProgram, "fontAtlas"), 0);
+	glyphCount = 0;
+	fontCount = 0;
+	textBatchDepth = 0;
+}
+
+void cleanupTextRenderer()
+{
+	glDeleteVertexArrays(1, &glyphVAO);
+	glDeleteVertexArrays(1, &fontVAO);
+	glDeleteBuffers(1, &glyphQuadVBO);
+	glDeleteBuffers(1, &glyphInstanceVBO);
+	glDeleteBuffers(1, &fontInstanceVBO);
+	resetGlStateCache();
+}
+
+// たまった文字を1回のインスタンス描画で出す（バッファは毎回捨てて作り直すので前の描画を待たない）
+static void flushGlyphs()
+{
+	if (glyphCount > 0) {
+		useProgram(glyphShaderProgram);
+		setBlend(false);
+		bindVertexArray(glyphVAO);
+		bindArrayBuffer(glyphInstanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(glyphInstances), NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, glyphCount * sizeof(GlyphInstance), glyphInstances);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, glyphCount);
+		glyphCount = 0;
+	}
+	if (fontCount > 0) {
+		// 縁はアルファでなめらかにするのでブレンドする
+		useProgram(fontShaderProgram);
+		setBlend(true);
+		bindTexture2D(fontTexture);
+		bindVertexArray(fontVAO);
+		bindArrayBuffer(fontInstanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(fontInstances), NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, fontCount * sizeof(FontInstance), fontInstances);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, fontCount);
+		fontCount = 0;
+	}
+}
+
+void beginTextBatch()
+{
+	textBatchDepth++;
+}
+
+void endTextBatch()
+{
+	if (textBatchDepth > 0 && --textBatchDepth == 0) flushGlyphs();
+}
+
+static void addGlyph(float x, float y, float size, const float color[3], uint64_t mask, uint32_t kind)
+{
+	if (mask == 0) return;  // 表にない文字は何も描かない
+	if (glyphCount == TEXT_MAX_GLYPHS) flushGlyphs();
+	GlyphInstance* glyph = &glyphInstances[glyphCount++];
+	glyph->x = x;
+	glyph->y = y;
+	glyph->size = size;
+	glyph->color[0] = color[0];
+	glyph->color[1] = color[1];
+	glyph->color[2] = color[2];
+	glyph->mask[0] = (uint32_t)mask;
+	glyph->mask[1] = (uint32_t)(mask >> 32);
+	glyph->kind = kind;
+}
+
+static uint64_t bitmapMask(char c)
+{
+	unsigned char index = (unsigned char)c;
+	return index < 128 ? kGlyphTable.masks[index] : 0;
+}
+
+static const FontGlyph* fontGlyph(char c)
+{
+	int index = (unsigned char)c - FONT_FIRST_CHAR;
+	return index >= 0 && index < FONT_CHAR_COUNT ? &fontGlyphs[index] : NULL;
+}
+
+// フォントの画素から画面座標への倍率（大文字の高さを、ビットマップ文字と同じ scale の 7/8 にそろえる）
+static float fontPixelScale(float scale)
+{
+	return scale * 0.875f / fontCapHeight;
+}
+
+// ペン位置 x、基準線 baseline に1文字置き、送り幅を返す
+static float addFontGlyph(char c, float x, float baseline, float pixelScale, const float color[3])
+{
+	const FontGlyph* glyph = fontGlyph(c);
+	if (!glyph) return 0.0f;
+	if (glyph->x2 > glyph->x1) {
+		if (fontCount == TEXT_MAX_GLYPHS) flushGlyphs();
+		FontInstance* instance = &fontInstances[fontCount++];
+		instance->rect[0] = x + glyph->x1 * pixelScale;
+		instance->rect[1] = baseline + glyph->y1 * pixelScale;
+		instance->rect[2] = x + glyph->x2 * pixelScale;
+		instance->rect[3] = baseline + glyph->y2 * pixelScale;
+		instance->uv[0] = glyph->u1;
+		instance->uv[1] = glyph->v1;
+		instance->uv[2] = glyph->u2;
+		instance->uv[3] = glyph->v2;
+		instance->color[0] = color[0];
+		instance->color[1] = color[1];
+		instance->color[2] = color[2];
 	}
+	return glyph->advance * pixelScale;
+}
+
+// ビットマップ文字の送り幅
+static float bitmapAdvance(char c, float scale)
+{
+	if (c >= '0' && c <= '9') return scale * 1.2f; // 数字間のスペースを広げる
+	if (c == '-' || c == ' ') return scale * 0.8f; // マイナス記号・スペースの幅
+	return scale * 1.0f;                           // 文字間のスペース
 }
 
 void renderText(const char* text, float x, float y, float scale, float color[3])
 {
 	float currentX = x;
+	if (fontLoaded) {
+		// ビットマップ文字の最下段（y から 1/8）を基準線にする
+		float pixelScale = fontPixelScale(scale);
+		for (int i = 0; text[i] != '\0'; i++) {
+			currentX += addFontGlyph(text[i], currentX, y + scale * 0.125f, pixelScale, color);
+		}
+	} else {
+		for (int i = 0; text[i] != '\0'; i++) {
+			if (text[i] >= '0' && text[i] <= '9') {
+				addGlyph(currentX, y, scale, color, kDigitSegments[text[i] - '0'], GLYPH_SEGMENTS);
+			} else if (text[i] == '-') {
+				// マイナス記号（7セグメントの中央と同じ棒）
+				addGlyph(currentX, y, scale, color, SEGMENT_MINUS, GLYPH_SEGMENTS);
+			} else if (text[i] != ' ') {
+				addGlyph(currentX, y, scale, color, bitmapMask(text[i]), GLYPH_BITMAP);
+			}
+			currentX += bitmapAdvance(text[i], scale);
+		}
+	}
+	if (textBatchDepth == 0) flushGlyphs();
+}
+
+float measureText(const char* text, float scale)
+{
+	float width = 0.0f;
 	for (int i = 0; text[i] != '\0'; i++) {
-		if (text[i] >= '0' && text[i] <= '9') {
-			renderDigit(text[i] - '0', currentX, y, scale, color);
-			currentX += scale * 1.2f; // 数字間のスペースを広げる
-		} else if (text[i] == '-') {
-			// マイナス記号を描画
-			float minusY = y + scale * 0.5f;
-			float minusHeight = scale * 0.08f;
-			float minusWidth = scale * 0.6f;
-			
-			float vertices[] = {
-				currentX, minusY, 0.0f, color[0], color[1], color[2],
-				currentX + minusWidth, minusY, 0.0f, color[0], color[1], color[2],
-				currentX + minusWidth, minusY - minusHeight, 0.0f, color[0], color[1], color[2],
-				currentX, minusY, 0.0f, color[0], color[1], color[2],
-				currentX + minusWidth, minusY - minusHeight, 0.0f, color[0], color[1], color[2],
-				currentX, minusY - minusHeight, 0.0f, color[0], color[1], color[2]
-			};
-			
-			glUseProgram(shaderProgram);
-			glBindVertexArray(gameVAO);
-			glBindBuffer(GL_ARRAY_BUFFER, gameVBO);
-			glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-			glEnableVertexAttribArray(0);
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-			glEnableVertexAttribArray(1);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-			
-			currentX += scale * 0.8f; // マイナス記号の幅
-		} else if (text[i] == '+') {
-			// プラス記号を描画
-			renderChar(text[i], currentX, y, scale, color);
-			currentX += scale * 1.0f; // プラス記号の幅
-		} else if (text[i] == ' ') {
-			currentX += scale * 0.8f; // スペースの幅
+		if (fontLoaded) {
+			const FontGlyph* glyph = fontGlyph(text[i]);
+			if (glyph) width += glyph->advance * fontPixelScale(scale);
 		} else {
-			// アルファベット文字をビットマップで描画
-			renderChar(text[i], currentX, y, scale, color);
-			currentX += scale * 1.0f; // 文字間のスペース
+			width += bitmapAdvance(text[i], scale);
 		}
 	}
+	return width;
 }
 
 void renderChar(char c, float x, float y, float scale, float color[3])
 {
-	// 各文字を簡単なビットマップパターンで描画
-	// 8x8ピクセルのパターンを使用
-	
-	// 文字パターンのデータ（8x8、1=描画、0=なし）
-	bool patterns[256][8][8];
-	memset(patterns, 0, sizeof(patterns));
-	
-	// 文字 'R'
-	bool R[8][8] = {
-		{1,1,1,1,1,1,0,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,1,1,1,1,1,0,0},
-		{1,0,0,1,0,0,0,0},
-		{1,0,0,0,1,0,0,0},
-		{1,0,0,0,0,1,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'E'
-	bool E[8][8] = {
-		{1,1,1,1,1,1,1,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,1,1,1,1,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,1,1,1,1,1,1,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'D'
-	bool D[8][8] = {
-		{1,1,1,1,1,1,0,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,1,1,1,1,1,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'B'
-	bool B[8][8] = {
-		{1,1,1,1,1,1,0,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,1,1,1,1,1,0,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,1,1,1,1,1,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'L'
-	bool L[8][8] = {
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,1,1,1,1,1,1,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'U'
-	bool U[8][8] = {
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{0,1,1,1,1,1,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'W'
-	bool W[8][8] = {
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,1,0,0,1,0},
-		{1,0,1,0,1,0,1,0},
-		{1,1,0,0,0,1,1,0},
-		{1,0,0,0,0,0,1,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'I'
-	bool I[8][8] = {
-		{0,1,1,1,1,1,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,1,1,1,1,1,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'N'
-	bool N[8][8] = {
-		{1,0,0,0,0,0,1,0},
-		{1,1,0,0,0,0,1,0},
-		{1,0,1,0,0,0,1,0},
-		{1,0,0,1,0,0,1,0},
-		{1,0,0,0,1,0,1,0},
-		{1,0,0,0,0,1,1,0},
-		{1,0,0,0,0,0,1,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'S'
-	bool S[8][8] = {
-		{0,1,1,1,1,1,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{0,1,1,1,1,0,0,0},
-		{0,0,0,0,0,0,1,0},
-		{0,0,0,0,0,0,1,0},
-		{0,1,1,1,1,1,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'T'
-	bool T[8][8] = {
-		{1,1,1,1,1,1,1,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'P'
-	bool P[8][8] = {
-		{1,1,1,1,1,1,0,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,1,1,1,1,1,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 '+'
-	bool Plus[8][8] = {
-		{0,0,0,0,0,0,0,0},
-		{0,0,0,1,1,0,0,0},
-		{0,0,0,1,1,0,0,0},
-		{0,1,1,1,1,1,1,0},
-		{0,0,0,1,1,0,0,0},
-		{0,0,0,1,1,0,0,0},
-		{0,0,0,1,1,0,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'O'
-	bool O[8][8] = {
-		{0,1,1,1,1,1,0,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{0,1,1,1,1,1,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'A'
-	bool A[8][8] = {
-		{0,0,1,1,1,0,0,0},
-		{0,1,0,0,0,1,0,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,1,1,1,1,1,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'C'
-	bool C[8][8] = {
-		{0,1,1,1,1,1,0,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,1,0},
-		{0,1,1,1,1,1,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'G'
-	bool G[8][8] = {
-		{0,1,1,1,1,1,0,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,1,1,1,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{0,1,1,1,1,1,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'M'
-	bool M[8][8] = {
-		{1,0,0,0,0,0,1,0},
-		{1,1,0,0,0,1,1,0},
-		{1,0,1,0,1,0,1,0},
-		{1,0,0,1,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'F'
-	bool F[8][8] = {
-		{1,1,1,1,1,1,1,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,1,1,1,1,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{1,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'H'
-	bool H[8][8] = {
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,1,1,1,1,1,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'V'
-	bool V[8][8] = {
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{0,1,0,0,0,1,0,0},
-		{0,0,1,0,1,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'Y'
-	bool Y[8][8] = {
-		{1,0,0,0,0,0,1,0},
-		{0,1,0,0,0,1,0,0},
-		{0,0,1,0,1,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'K'
-	bool K[8][8] = {
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,1,0,0},
-		{1,0,0,0,1,0,0,0},
-		{1,0,0,1,0,0,0,0},
-		{1,0,1,0,0,0,0,0},
-		{1,1,0,0,0,0,0,0},
-		{1,0,1,0,0,0,0,0},
-		{1,0,0,1,0,0,0,0}
-	};
-	
-	// 文字 'J'
-	bool J[8][8] = {
-		{1,1,1,1,1,1,1,0},
-		{0,0,0,0,1,0,0,0},
-		{0,0,0,0,1,0,0,0},
-		{0,0,0,0,1,0,0,0},
-		{0,0,0,0,1,0,0,0},
-		{1,0,0,0,1,0,0,0},
-		{0,1,1,1,0,0,0,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'Q'
-	bool Q[8][8] = {
-		{0,1,1,1,1,1,0,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,0,0,0,1,0},
-		{1,0,0,1,0,0,1,0},
-		{1,0,0,0,1,0,1,0},
-		{0,1,1,1,1,1,1,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'X'
-	bool X[8][8] = {
-		{1,0,0,0,0,0,1,0},
-		{0,1,0,0,0,1,0,0},
-		{0,0,1,0,1,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,1,0,1,0,0,0},
-		{0,1,0,0,0,1,0,0},
-		{1,0,0,0,0,0,1,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// 文字 'Z'
-	bool Z[8][8] = {
-		{1,1,1,1,1,1,1,0},
-		{0,0,0,0,0,1,0,0},
-		{0,0,0,0,1,0,0,0},
-		{0,0,0,1,0,0,0,0},
-		{0,0,1,0,0,0,0,0},
-		{0,1,0,0,0,0,0,0},
-		{1,1,1,1,1,1,1,0},
-		{0,0,0,0,0,0,0,0}
-	};
-	
-	// パターンを配列にコピー
-	memcpy(patterns['R'], R, sizeof(R));
-	memcpy(patterns['E'], E, sizeof(E));
-	memcpy(patterns['D'], D, sizeof(D));
-	memcpy(patterns['B'], B, sizeof(B));
-	memcpy(patterns['L'], L, sizeof(L));
-	memcpy(patterns['U'], U, sizeof(U));
-	memcpy(patterns['W'], W, sizeof(W));
-	memcpy(patterns['I'], I, sizeof(I));
-	memcpy(patterns['N'], N, sizeof(N));
-	memcpy(patterns['S'], S, sizeof(S));
-	memcpy(patterns['T'], T, sizeof(T));
-	memcpy(patterns['P'], P, sizeof(P));
-	memcpy(patterns['+'], Plus, sizeof(Plus));
-	memcpy(patterns['O'], O, sizeof(O));
-	memcpy(patterns['A'], A, sizeof(A));
-	memcpy(patterns['C'], C, sizeof(C));
-	memcpy(patterns['G'], G, sizeof(G));
-	memcpy(patterns['M'], M, sizeof(M));
-	memcpy(patterns['F'], F, sizeof(F));
-	memcpy(patterns['H'], H, sizeof(H));
-	memcpy(patterns['V'], V, sizeof(V));
-	memcpy(patterns['Y'], Y, sizeof(Y));
-	memcpy(patterns['K'], K, sizeof(K));
-	memcpy(patterns['J'], J, sizeof(J));
-	memcpy(patterns['Q'], Q, sizeof(Q));
-	memcpy(patterns['X'], X, sizeof(X));
-	memcpy(patterns['Z'], Z, sizeof(Z));
-	
-	// スペースは何も描画しない
-	if (c == ' ') return;
-	
-	// 該当する文字のパターンを取得
-	if (c < 0 || c >= 256) return;
-	
-	float pixelSize = scale / 8.0f;
-	
-	glUseProgram(shaderProgram);
-	glBindVertexArray(gameVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, gameVBO);
-	
-	// 8x8のピクセルを描画
-	for (int row = 0; row < 8; row++) {
-		for (int col = 0; col < 8; col++) {
-			if (patterns[c][row][col]) {
-				float px = x + col * pixelSize;
-				float py = y + (7 - row) * pixelSize; // Y軸を反転
-				
-				float vertices[] = {
-					px, py, 0.0f, color[0], color[1], color[2],
-					px + pixelSize, py, 0.0f, color[0], color[1], color[2],
-					px + pixelSize, py + pixelSize, 0.0f, color[0], color[1], color[2],
-					px, py, 0.0f, color[0], color[1], color[2],
-					px + pixelSize, py + pixelSize, 0.0f, color[0], color[1], color[2],
-					px, py + pixelSize, 0.0f, color[0], color[1], color[2]
-				};
-				
-				glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-				glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-				glEnableVertexAttribArray(0);
-				glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-				glEnableVertexAttribArray(1);
-				glDrawArrays(GL_TRIANGLES, 0, 6);
-			}
-		}
+	if (fontLoaded) {
+		addFontGlyph(c, x, y + scale * 0.125f, fontPixelScale(scale), color);
+	} else {
+		addGlyph(x, y, scale, color, bitmapMask(c), GLYPH_BITMAP);
 	}
+	if (textBatchDepth == 0) flushGlyphs();
 }
 
 void renderScore(int redScore, int blueScore)
@@ -549,11 +506,11 @@ void renderScore(int redScore, int blueScore)
 	float rightX = 0.6f;
 	float scoreY = 0.8f;
 	
-	// 赤スコア表示
+	// 赤と青のスコアは1回でまとめて描く
+	beginTextBatch();
 	renderText(redScoreStr, leftX, scoreY, scoreSize, redColor);
-	
-	// 青スコア表示  
 	renderText(blueScoreStr, rightX, scoreY, scoreSize, blueColor);
+	endTextBatch();
 }
 
 void renderGameOverScreen(Player winner)
@@ -572,49 +529,39 @@ void renderGameOverScreen(Player winner)
 		-1.0f,  1.0f, 0.0f,    overlayColor[0], overlayColor[1], overlayColor[2]
 	};
 	
-	glUseProgram(shaderProgram);
-	glBindVertexArray(gameVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, gameVBO);
+	useProgram(shaderProgram);
 	
 	// アルファブレンディングを有効化
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	setBlend(true);
 	
 	// オーバーレイ描画
-	glBufferData(GL_ARRAY_BUFFER, sizeof(overlayVertices), overlayVertices, GL_DYNAMIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	glDrawArrays(GL_TRIANGLES, 0, 6);
-	
-	glDisable(GL_BLEND);
+	drawVertices(VERTEX_FORMAT_COLOR, overlayVertices, 6);
 	
 	// 勝敗テキストを描画
 	float textScale = 0.25f;
 	float textColor[3] = {1.0f, 1.0f, 1.0f}; // 白色
 	
+	// 勝敗と再開の案内はオーバーレイの上に1回でまとめて描く
+	beginTextBatch();
 	if (winner == PLAYER_TIE) {
 		// "TIE"を中央に表示
-		renderText("TIE", -0.3f, -0.1f, textScale, textColor);
+		renderText("TIE", -measureText("TIE", textScale) / 2.0f, -0.1f, textScale, textColor);
 	} else if (winner == PLAYER_RED) {
 		// "RED WINS"を中央に表示
 		float redColor[3] = {1.0f, 0.3f, 0.3f};
-		renderText("RED", -0.35f, 0.1f, textScale, redColor);
-		renderText("WINS", -0.4f, -0.2f, textScale, textColor);
+		renderText("RED", -measureText("RED", textScale) / 2.0f, 0.1f, textScale, redColor);
+		renderText("WINS", -measureText("WINS", textScale) / 2.0f, -0.2f, textScale, textColor);
 	} else if (winner == PLAYER_BLUE) {
 		// "BLUE WINS"を中央に表示
 		float blueColor[3] = {0.3f, 0.3f, 1.0f};
-		renderText("BLUE", -0.4f, 0.1f, textScale, blueColor);
-		renderText("WINS", -0.4f, -0.2f, textScale, textColor);
+		renderText("BLUE", -measureText("BLUE", textScale) / 2.0f, 0.1f, textScale, blueColor);
+		renderText("WINS", -measureText("WINS", textScale) / 2.0f, -0.2f, textScale, textColor);
 	}
 	
-	// "Press R to restart"メッセージ
+	// "Press R to restart"メッセージ（中央配置）
 	float smallTextScale = 0.08f;  // より小さなサイズに変更
-	// 文字列の長さを計算して中央配置
 	const char* restartText = "PRESS R TO RESTART";
-	int textLength = strlen(restartText);
-	float textWidth = textLength * smallTextScale * 1.0f;  // 概算の文字幅
-	float centerX = -textWidth / 2.0f;  // 中央配置のX座標
+	float centerX = -measureText(restartText, smallTextScale) / 2.0f;
 	renderText(restartText, centerX, -0.7f, smallTextScale, textColor);
+	endTextBatch();
 }
\ No newline at end of file
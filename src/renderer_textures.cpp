@@ -1,21 +1,105 @@
 #include "renderer.h"
+#include <vector>
 
-unsigned int textureVAO, textureVBO;
-unsigned int plusOneTexture, minusOneTexture, plusTwoTexture;
+unsigned int atlasTexture;
+AtlasRegion atlasRegions[SPRITE_COUNT];
 
+// アトラスに詰める画像（Sprite の順。UI用の画像を増やすときはここと Sprite に足す）
+static const char* kSpritePaths[SPRITE_COUNT] = {
+	"img/plus_1.png",   // SPRITE_PLUS_ONE
+	"img/plus_2.png",   // SPRITE_PLUS_TWO
+	"img/neg_1.png"     // SPRITE_MINUS_ONE
+};
 
+#define ATLAS_WIDTH 256
+#define ATLAS_PADDING 2   // 線形補間で隣の画像がにじまないよう透明の隙間を空ける
+
+typedef struct {
+	unsigned char* pixels;   // RGBA、下の行から（stbi_set_flip_vertically_on_load）
+	int width, height;
+	int x, y;                // アトラス内の左下
+} AtlasImage;
+
+static int nextPowerOfTwo(int value)
+{
+	int result = 1;
+	while (result < value) result *= 2;
+	return result;
+}
+
+// 起動時に画像を1枚のテクスチャへ棚詰めし、画像ごとのテクスチャ座標を atlasRegions に書く
+// 読めなかった画像は loaded = false のまま（ほかの画像は使える）
 void setupTextures()
 {
+	cleanupTextures();
+	
 	// 画像を読み込み（c_puzzleディレクトリから相対パス）
-	plusOneTexture = loadTexture("img/plus_1.png");
-	minusOneTexture = loadTexture("img/neg_1.png");
-	plusTwoTexture = loadTexture("img/plus_2.png");
+	stbi_set_flip_vertically_on_load(true);  // OpenGL用に上下反転
+	AtlasImage images[SPRITE_COUNT];
+	int shelfX = ATLAS_PADDING, shelfY = ATLAS_PADDING, shelfHeight = 0;
+	bool anyLoaded = false;
+	for (int i = 0; i < SPRITE_COUNT; i++) {
+		AtlasImage* image = &images[i];
+		int channels;
+		image->pixels = stbi_load(kSpritePaths[i], &image->width, &image->height, &channels, 4);
+		if (!image->pixels || image->width + 2 * ATLAS_PADDING > ATLAS_WIDTH) {
+			printf("テクスチャ読み込み失敗: %s\n", kSpritePaths[i]);
+			printf("エラー詳細: %s\n", image->pixels ? "アトラスの幅を超えています" : stbi_failure_reason());
+			printf("ファイルの確認を行ってください。\n");
+			if (image->pixels) stbi_image_free(image->pixels);
+			image->pixels = NULL;
+			continue;
+		}
+		// 棚に収まらなければ次の棚へ
+		if (shelfX + image->width + ATLAS_PADDING > ATLAS_WIDTH) {
+			shelfX = ATLAS_PADDING;
+			shelfY += shelfHeight + ATLAS_PADDING;
+			shelfHeight = 0;
+		}
+		image->x = shelfX;
+		image->y = shelfY;
+		shelfX += image->width + ATLAS_PADDING;
+		if (image->height > shelfHeight) shelfHeight = image->height;
+		anyLoaded = true;
+	}
+	if (!anyLoaded) return;
+	
+	int atlasHeight = nextPowerOfTwo(shelfY + shelfHeight + ATLAS_PADDING);
+	std::vector<unsigned char> pixels((size_t)ATLAS_WIDTH * atlasHeight * 4, 0);
+	for (int i = 0; i < SPRITE_COUNT; i++) {
+		AtlasImage* image = &images[i];
+		if (!image->pixels) continue;
+		for (int row = 0; row < image->height; row++) {
+			memcpy(&pixels[((size_t)(image->y + row) * ATLAS_WIDTH + image->x) * 4],
+			       image->pixels + (size_t)row * image->width * 4, (size_t)image->width * 4);
+		}
+		AtlasRegion* region = &atlasRegions[i];
+		region->u1 = (float)image->x / ATLAS_WIDTH;
+		region->v1 = (float)image->y / atlasHeight;
+		region->u2 = (float)(image->x + image->width) / ATLAS_WIDTH;
+		region->v2 = (float)(image->y + image->height) / atlasHeight;
+		region->loaded = true;
+		printf("テクスチャ読み込み成功: %s (%dx%d)\n", kSpritePaths[i], image->width, image->height);
+		stbi_image_free(image->pixels);
+	}
+	
+	// アイコンは拡大して表示するだけなのでミップマップは作らない
+	glGenTextures(1, &atlasTexture);
+	bindTexture2D(atlasTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ATLAS_WIDTH, atlasHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	printf("アトラス作成: %dx%d\n", ATLAS_WIDTH, atlasHeight);
 }
 
 void cleanupTextures()
 {
-	glDeleteTextures(1, &plusOneTexture);
-	glDeleteTextures(1, &minusOneTexture);
+	if (atlasTexture != 0) glDeleteTextures(1, &atlasTexture);
+	atlasTexture = 0;
+	resetGlStateCache();
+	memset(atlasRegions, 0, sizeof(atlasRegions));
 }
 
 unsigned int loadTexture(const char* path)
@@ -36,7 +120,7 @@ unsigned int loadTexture(const char* path)
 		else if (nrChannels == 4)
 			format = GL_RGBA;
 		
-		glBindTexture(GL_TEXTURE_2D, textureID);
+		bindTexture2D(textureID);
 		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
 		glGenerateMipmap(GL_TEXTURE_2D);
 		
@@ -61,48 +145,37 @@ unsigned int loadTexture(const char* path)
 	return textureID;
 }
 
-void renderTexture(unsigned int texture, float x1, float y1, float x2, float y2)
+void renderSprite(Sprite sprite, float x1, float y1, float x2, float y2)
 {
-	if (texture == 0) return;  // テクスチャが無効な場合は何もしない
+	const AtlasRegion* region = &atlasRegions[sprite];
+	if (!region->loaded) return;  // 画像が読めなかった場合は何もしない
 	
-	// 現在のシェーダーを保存
-	GLint currentProgram;
-	glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+	// 現在のシェーダーを保存（GLに問い合わせずキャッシュから）
+	unsigned int previousProgram = getCurrentProgram();
 	
 	// テクスチャ用頂点データ
 	float vertices[] = {
 		// 位置           // テクスチャ座標
-		x1, y1, 0.0f,    0.0f, 1.0f,  // 左下
-		x2, y1, 0.0f,    1.0f, 1.0f,  // 右下
-		x2, y2, 0.0f,    1.0f, 0.0f,  // 右上
-		x1, y1, 0.0f,    0.0f, 1.0f,  // 左下
-		x2, y2, 0.0f,    1.0f, 0.0f,  // 右上
-		x1, y2, 0.0f,    0.0f, 0.0f   // 左上
+		x1, y1, 0.0f,    region->u1, region->v2,  // 左下
+		x2, y1, 0.0f,    region->u2, region->v2,  // 右下
+		x2, y2, 0.0f,    region->u2, region->v1,  // 右上
+		x1, y1, 0.0f,    region->u1, region->v2,  // 左下
+		x2, y2, 0.0f,    region->u2, region->v1,  // 右上
+		x1, y2, 0.0f,    region->u1, region->v1   // 左上
 	};
 	
-	// テクスチャシェーダとVAOを使用
-	glUseProgram(textureShaderProgram);
-	glBindVertexArray(textureVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, textureVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-	
-	// 頂点属性の設定
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
+	// テクスチャシェーダを使用
+	useProgram(textureShaderProgram);
 	
 	// テクスチャをバインド
-	glBindTexture(GL_TEXTURE_2D, texture);
+	bindTexture2D(atlasTexture);
 	
 	// アルファブレンディングを有効化
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	setBlend(true);
 	
 	// 描画
-	glDrawArrays(GL_TRIANGLES, 0, 6);
+	drawVertices(VERTEX_FORMAT_TEXTURE, vertices, 6);
 	
-	// 状態を戻す
-	glDisable(GL_BLEND);
-	glUseProgram(currentProgram);
+	// シェーダーを戻す
+	useProgram(previousProgram);
 }
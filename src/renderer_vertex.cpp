@@ -0,0 +1,163 @@
+#include "renderer.h"
+#include <assert.h>
+
+// 形式ごとのVAO（属性は作成時に一度だけ設定する）。頂点はすべて1本のリングバッファに流し込む
+static unsigned int streamVAO[VERTEX_FORMAT_COUNT];
+
+// 動的な頂点のリングバッファ
+// GL 4.4 以降: glBufferStorage で作って永続的に写像し、区画ごとのフェンスでGPUが読み終えたか確かめてから上書きする
+// GL 3.3: 確保のたびに書く範囲だけを同期なしで写像し、末尾に達したら glBufferData で中身を捨てて（orphaning）先頭に戻る
+#define STREAM_BUFFER_BYTES (1 << 20)
+#define STREAM_SEGMENTS 4
+#define STREAM_SEGMENT_BYTES (STREAM_BUFFER_BYTES / STREAM_SEGMENTS)
+
+static unsigned int streamBuffer;
+static bool streamPersistent = false;
+static unsigned char* streamMemory = NULL;       // 永続写像の先頭
+static GLsync segmentFences[STREAM_SEGMENTS];    // 区画を使い終えたときに入れたフェンス
+static int streamOffset = 0;                     // 次に書く位置（バイト）
+static int streamSegment = 0;                    // 永続写像で今書いている区画
+static bool streamMapped = false;                // GL 3.3 で確保した範囲を写像中
+
+// 最後に確保した頂点（drawStreamVertices で描く）
+static VertexFormat pendingFormat;
+static int pendingFirst = 0;
+static int pendingCount = 0;
+
+int vertexFormatFloats(VertexFormat format)
+{
+	return format == VERTEX_FORMAT_COLOR ? VERTEX_COLOR_FLOATS : VERTEX_TEXTURE_FLOATS;
+}
+
+void configureVertexFormat(VertexFormat format)
+{
+	int stride = vertexFormatFloats(format) * sizeof(float);
+	int secondSize = format == VERTEX_FORMAT_COLOR ? 3 : 2;   // 色3 / テクスチャ座標2
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, secondSize, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+}
+
+void setupVertexFormats()
+{
+	glGenBuffers(1, &streamBuffer);
+	bindArrayBuffer(streamBuffer);
+	streamPersistent = GLAD_GL_VERSION_4_4 && glBufferStorage != NULL;
+	if (streamPersistent) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, STREAM_BUFFER_BYTES, NULL, flags);
+		streamMemory = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, STREAM_BUFFER_BYTES, flags);
+		streamPersistent = streamMemory != NULL;
+	}
+	if (!streamPersistent) {
+		glBufferData(GL_ARRAY_BUFFER, STREAM_BUFFER_BYTES, NULL, GL_STREAM_DRAW);
+	}
+	memset(segmentFences, 0, sizeof(segmentFences));
+	streamOffset = 0;
+	streamSegment = 0;
+	streamMapped = false;
+	printf("頂点リングバッファ: %dKB (%s)\n", STREAM_BUFFER_BYTES / 1024,
+	       streamPersistent ? "永続写像" : "orphaning");
+
+	// どの形式も同じバッファの先頭から属性を読み、描画開始位置は頂点番号で指定する
+	glGenVertexArrays(VERTEX_FORMAT_COUNT, streamVAO);
+	for (int i = 0; i < VERTEX_FORMAT_COUNT; i++) {
+		bindVertexArray(streamVAO[i]);
+		configureVertexFormat((VertexFormat)i);
+	}
+}
+
+void cleanupVertexFormats()
+{
+	bindArrayBuffer(streamBuffer);
+	if (streamPersistent || streamMapped) glUnmapBuffer(GL_ARRAY_BUFFER);
+	for (int i = 0; i < STREAM_SEGMENTS; i++) {
+		if (segmentFences[i]) glDeleteSync(segmentFences[i]);
+		segmentFences[i] = 0;
+	}
+	streamMemory = NULL;
+	streamMapped = false;
+	glDeleteVertexArrays(VERTEX_FORMAT_COUNT, streamVAO);
+	glDeleteBuffers(1, &streamBuffer);
+	resetGlStateCache();
+}
+
+// 区画に入る前に、前回その区画を使った描画をGPUが読み終えるのを待つ
+static void enterSegment(int segment)
+{
+	if (!segmentFences[segment]) return;
+	while (glClientWaitSync(segmentFences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+	glDeleteSync(segmentFences[segment]);
+	segmentFences[segment] = 0;
+}
+
+// 永続写像: 今の区画に入りきらなければ使い終えた区画にフェンスを入れ、次の区画の空きを待つ
+// 区画の先頭は頂点サイズの倍数とは限らないので、次の区画では頂点サイズにそろえた位置から書く
+static int reservePersistent(int offset, int bytes, int stride)
+{
+	if (offset + bytes <= (streamSegment + 1) * STREAM_SEGMENT_BYTES) return offset;
+
+	segmentFences[streamSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	streamSegment = (streamSegment + 1) % STREAM_SEGMENTS;
+	enterSegment(streamSegment);
+	return (streamSegment * STREAM_SEGMENT_BYTES + stride - 1) / stride * stride;
+}
+
+// GL 3.3: 入りきらなければ orphaning で新しい領域に替えて先頭から書く
+static int reserveOrphaning(int offset, int bytes)
+{
+	if (offset + bytes <= STREAM_BUFFER_BYTES) return offset;
+	glBufferData(GL_ARRAY_BUFFER, STREAM_BUFFER_BYTES, NULL, GL_STREAM_DRAW);
+	return 0;
+}
+
+float* allocStreamVertices(VertexFormat format, int vertexCount)
+{
+	int stride = vertexFormatFloats(format) * sizeof(float);
+	int bytes = vertexCount * stride;
+	// 区画の先頭をそろえて詰める分（最大 stride - 1）を引いても1区画に収まる量まで
+	if (vertexCount <= 0 || bytes > STREAM_SEGMENT_BYTES - stride) return NULL;
+
+	// 描画開始位置を頂点番号で表せるよう、形式の頂点サイズの倍数にそろえる
+	int offset = (streamOffset + stride - 1) / stride * stride;
+	bindArrayBuffer(streamBuffer);
+	offset = streamPersistent ? reservePersistent(offset, bytes, stride) : reserveOrphaning(offset, bytes);
+
+	void* memory;
+	if (streamPersistent) {
+		memory = streamMemory + offset;
+	} else {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+		memory = glMapBufferRange(GL_ARRAY_BUFFER, offset, bytes, flags);
+		if (!memory) return NULL;
+		streamMapped = true;
+	}
+	assert(offset % stride == 0);
+	streamOffset = offset + bytes;
+	pendingFormat = format;
+	pendingFirst = offset / stride;
+	pendingCount = vertexCount;
+	return (float*)memory;
+}
+
+void drawStreamVertices()
+{
+	if (streamMapped) {
+		bindArrayBuffer(streamBuffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		streamMapped = false;
+	}
+	if (pendingCount == 0) return;
+	bindVertexArray(streamVAO[pendingFormat]);
+	glDrawArrays(GL_TRIANGLES, pendingFirst, pendingCount);
+	pendingCount = 0;
+}
+
+void drawVertices(VertexFormat format, const float* vertices, int vertexCount)
+{
+	float* memory = allocStreamVertices(format, vertexCount);
+	if (!memory) return;
+	memcpy(memory, vertices, vertexCount * vertexFormatFloats(format) * sizeof(float));
+	drawStreamVertices();
+}
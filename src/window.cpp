@@ -4,6 +4,14 @@
 #include "game.h"
 #include <iostream>
 
+// ウィンドウの再描画が必要になった（露出・サイズ変更など、ゲームの状態からは分からないもの）
+static bool windowRefreshRequested = true;
+
+static void windowRefreshCallback(GLFWwindow*)
+{
+	windowRefreshRequested = true;
+}
+
 bool initGLFW() 
 {
 	if (!glfwInit()) 
@@ -29,6 +37,7 @@ GLFWwindow* createWindow(int width, int height, const char* title)
 		glfwMakeContextCurrent(window);
 		// マウスコールバックを設定
 		glfwSetMouseButtonCallback(window, mouseCallback);
+		glfwSetWindowRefreshCallback(window, windowRefreshCallback);
 	}
 	return window;
 }
@@ -50,8 +59,58 @@ void cleanup(GLFWwindow* window)
 	glfwTerminate();
 }
 
-void mainLoop(GLFWwindow* window)
+// 見た目に関わる状態（前回描いたときと違えば描き直す）
+typedef struct {
+	uint32_t revision;
+	EffectState effectState;
+	double effectStartTime;
+	bool gameOver;
+	bool analysisOverlay;
+} DrawnState;
+
+static DrawnState captureDrawnState(const GameState* game)
+{
+	DrawnState state;
+	state.revision = game->revision;
+	state.effectState = game->effectState;
+	state.effectStartTime = game->effectStartTime;
+	state.gameOver = game->gameOver;
+	state.analysisOverlay = isAnalysisOverlayEnabled();
+	return state;
+}
+
+static bool sameDrawnState(const DrawnState* a, const DrawnState* b)
 {
+	return a->revision == b->revision && a->effectState == b->effectState &&
+	       a->effectStartTime == b->effectStartTime && a->gameOver == b->gameOver &&
+	       a->analysisOverlay == b->analysisOverlay;
+}
+
+#define ANALYSIS_REFRESH_INTERVAL 0.25   // 勝率オーバーレイの更新間隔（秒）
+
+// 時間で進む処理（+2演出の切り替え、AIの待機、勝率の更新）のうち次に描き直す時刻。なければ負
+static double nextRedrawTime(const GameState* game, double lastDrawTime)
+{
+	double next = -1.0;
+	if (game->effectState == EFFECT_WAITING) next = game->effectStartTime + 0.5;
+	if (game->effectState == EFFECT_DARKENING) next = game->effectStartTime + 2.0;
+	if (game->waitingForAI && !game->gameOver) {
+		double aiTime = game->aiStartTime + 1.0;
+		if (next < 0 || aiTime < next) next = aiTime;
+	}
+	if (isAnalysisOverlayEnabled() && !game->gameOver) {
+		double refreshTime = lastDrawTime + ANALYSIS_REFRESH_INTERVAL;
+		if (next < 0 || refreshTime < next) next = refreshTime;
+	}
+	return next;
+}
+
+void mainLoop(GLFWwindow* window, bool renderOnDemand)
+{
+	bool analysisKeyDown = false;
+	GameState* game = getGameState();
+	DrawnState drawn = captureDrawnState(game);
+	double lastDrawTime = 0.0;
 	while (!glfwWindowShouldClose(window)) 
 	{
 		if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
@@ -61,16 +120,57 @@ void mainLoop(GLFWwindow* window)
 		if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS)
 			resetGame();
 
+		// A キーで勝率オーバーレイを切り替え（押した瞬間のみ）
+		bool analysisKeyPressed = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
+		if (analysisKeyPressed && !analysisKeyDown)
+			setAnalysisOverlay(!isAnalysisOverlayEnabled());
+		analysisKeyDown = analysisKeyPressed;
+
 		// AI更新
 		updateAI();
 
-		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
+		// 状態が変わった・時間で進む処理の時刻になった・ウィンドウが露出したときだけ描く
+		double now = glfwGetTime();
+		DrawnState current = captureDrawnState(game);
+		double redrawTime = nextRedrawTime(game, lastDrawTime);
+		bool redraw = !renderOnDemand || windowRefreshRequested || !sameDrawnState(&current, &drawn) ||
+		              (redrawTime >= 0 && now >= redrawTime);
+		if (redraw)
+		{
+			glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+
+			// ゲームを描画
+			renderGame();
 
-		// ゲームを描画
-		renderGame();
+			glfwSwapBuffers(window);
+			windowRefreshRequested = false;
+			lastDrawTime = now;
+			drawn = captureDrawnState(game);  // 描画中に演出が進むことがあるので描いた後の状態を覚える
+		}
 
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		if (!renderOnDemand)
+		{
+			glfwPollEvents();
+			continue;
+		}
+		// 描いた直後に状態が変わっていれば（演出の終了で+2が反映されたなど）すぐ次を描く
+		current = captureDrawnState(game);
+		if (!sameDrawnState(&current, &drawn))
+		{
+			glfwPollEvents();
+			continue;
+		}
+		// 次の入力か、時間で進む処理の時刻まで眠る
+		redrawTime = nextRedrawTime(game, lastDrawTime);
+		if (redrawTime < 0)
+		{
+			glfwWaitEvents();
+		}
+		else
+		{
+			double timeout = redrawTime - glfwGetTime();
+			glfwWaitEventsTimeout(timeout > 0.0 ? timeout : 0.0);
+		}
 	}
 }
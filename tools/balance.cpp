@@ -0,0 +1,358 @@
+// ゲームバランスの集計（設定ファイルに並べた実験を順に全コアで対局する）
+//   puzzle_balance <experiments.cfg> [--csv out.csv] [--json out.json] [--threads 0]
+//
+// 設定ファイルは1行1実験で「名前 red=<controller> blue=<controller> games=N [seed=S]」。# 以降はコメント
+// 実験ごとに、先手（赤）の勝率の偏り、残り3列の+2変化の時点でリードしていた側が負けた割合、
+// 得点差の分布（平均・標準偏差・10/50/90パーセンタイル）を求める
+#include "match.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#define MARGIN_RANGE 128   // 得点差の度数分布は -128..128 に丸める
+
+typedef struct {
+    char name[64];
+    Controller red;
+    Controller blue;
+    char redName[32];
+    char blueName[32];
+    int games;
+    uint64_t seed;
+} Experiment;
+
+// 実験1つ分の集計（ワーカーごとに持って最後に足す）
+typedef struct {
+    long long games;
+    long long redWins;
+    long long blueWins;
+    long long ties;
+    long long truncated;
+    long long plies;
+    long long triggered;         // +2変化が起きた対局
+    long long triggerLeaderLost; // 変化の時点でリードしていた側が勝てなかった
+    long long triggerTied;       // 変化の時点で同点だった
+    double pointsAfterTrigger;   // 変化の後に両者が得た点の合計
+    double redScoreSum;
+    double blueScoreSum;
+    double marginSum;            // 赤 - 青
+    double marginSquareSum;
+    int minMargin;
+    int maxMargin;
+    long long marginHistogram[2 * MARGIN_RANGE + 1];
+} BalanceStats;
+
+typedef struct {
+    Experiment experiment;
+    BalanceStats stats;
+    double seconds;
+} ExperimentResult;
+
+static void printUsage() {
+    printf("usage: puzzle_balance <experiments> [--csv <file>] [--json <file>] [--threads N]\n");
+    printf("  experiments: one per line, \"name red=<controller> blue=<controller> games=N [seed=S]\"\n");
+}
+
+static void resetStats(BalanceStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->minMargin = 1 << 30;
+    stats->maxMargin = -(1 << 30);
+}
+
+static void mergeStats(BalanceStats* into, const BalanceStats* from) {
+    into->games += from->games;
+    into->redWins += from->redWins;
+    into->blueWins += from->blueWins;
+    into->ties += from->ties;
+    into->truncated += from->truncated;
+    into->plies += from->plies;
+    into->triggered += from->triggered;
+    into->triggerLeaderLost += from->triggerLeaderLost;
+    into->triggerTied += from->triggerTied;
+    into->pointsAfterTrigger += from->pointsAfterTrigger;
+    into->redScoreSum += from->redScoreSum;
+    into->blueScoreSum += from->blueScoreSum;
+    into->marginSum += from->marginSum;
+    into->marginSquareSum += from->marginSquareSum;
+    if (from->minMargin < into->minMargin) into->minMargin = from->minMargin;
+    if (from->maxMargin > into->maxMargin) into->maxMargin = from->maxMargin;
+    for (int i = 0; i <= 2 * MARGIN_RANGE; i++) into->marginHistogram[i] += from->marginHistogram[i];
+}
+
+// 1行を読む。空行・コメントだけの行は *isEmpty を立てて true を返す
+static bool parseExperimentLine(char* line, Experiment* experiment, bool* isEmpty) {
+    char* comment = strchr(line, '#');
+    if (comment) *comment = '\0';
+    memset(experiment, 0, sizeof(*experiment));
+    experiment->seed = 1;
+    bool hasRed = false, hasBlue = false;
+
+    int tokenIndex = 0;
+    for (char* token = strtok(line, " \t\r\n"); token; token = strtok(NULL, " \t\r\n"), tokenIndex++) {
+        if (tokenIndex == 0) {
+            snprintf(experiment->name, sizeof(experiment->name), "%s", token);
+        } else if (strncmp(token, "red=", 4) == 0) {
+            hasRed = parseController(token + 4, &experiment->red);
+        } else if (strncmp(token, "blue=", 5) == 0) {
+            hasBlue = parseController(token + 5, &experiment->blue);
+        } else if (strncmp(token, "games=", 6) == 0) {
+            experiment->games = atoi(token + 6);
+        } else if (strncmp(token, "seed=", 5) == 0) {
+            experiment->seed = strtoull(token + 5, NULL, 10);
+        } else {
+            return false;
+        }
+    }
+    *isEmpty = (tokenIndex == 0);
+    if (*isEmpty) return true;
+    formatController(&experiment->red, experiment->redName, sizeof(experiment->redName));
+    formatController(&experiment->blue, experiment->blueName, sizeof(experiment->blueName));
+    return hasRed && hasBlue && experiment->games > 0 &&
+           experiment->red.kind != CONTROLLER_HUMAN && experiment->blue.kind != CONTROLLER_HUMAN;
+}
+
+static bool loadExperiments(const char* path, std::vector<Experiment>* experiments) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "設定ファイルを開けません: %s\n", path);
+        return false;
+    }
+    char line[512];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), fp)) {
+        lineNumber++;
+        Experiment experiment;
+        bool isEmpty = false;
+        if (!parseExperimentLine(line, &experiment, &isEmpty)) {
+            fprintf(stderr, "%s:%d: 実験の書式が不正です\n", path, lineNumber);
+            ok = false;
+        } else if (!isEmpty) {
+            experiments->push_back(experiment);
+        }
+    }
+    fclose(fp);
+    return ok && !experiments->empty();
+}
+
+// 1局を打ち、+2変化の時点の得点も見ながら集計する（playMatch と同じ進め方）
+static void playBalanceGame(const Experiment* experiment, uint64_t seed, BalanceStats* stats) {
+    GameState state;
+    memset(&state, 0, sizeof(state));
+    seedGame(&state, seed);
+    resetGame(&state);
+
+    bool triggered = false;
+    int triggerRed = 0, triggerBlue = 0;
+    while (!state.gameOver && state.plies < MATCH_MAX_PLIES) {
+        const Controller* controller = state.currentPlayer == PLAYER_RED ? &experiment->red : &experiment->blue;
+        int col = chooseControllerMove(controller, &state, NULL);
+        if (col < 0 || !playMove(&state, col)) break;
+        if (!triggered && state.plusTwoTriggered) {
+            triggered = true;
+            triggerRed = state.redScore;
+            triggerBlue = state.blueScore;
+        }
+    }
+
+    Player winner = getWinner(&state);
+    stats->games++;
+    if (winner == PLAYER_RED) stats->redWins++;
+    else if (winner == PLAYER_BLUE) stats->blueWins++;
+    else stats->ties++;
+    if (!state.gameOver) stats->truncated++;
+    stats->plies += state.plies;
+    stats->redScoreSum += state.redScore;
+    stats->blueScoreSum += state.blueScore;
+
+    if (triggered) {
+        stats->triggered++;
+        Player leader = triggerRed > triggerBlue ? PLAYER_RED : (triggerBlue > triggerRed ? PLAYER_BLUE : PLAYER_TIE);
+        if (leader == PLAYER_TIE) stats->triggerTied++;
+        else if (winner != leader) stats->triggerLeaderLost++;
+        stats->pointsAfterTrigger += (state.redScore - triggerRed) + (state.blueScore - triggerBlue);
+    }
+
+    int margin = state.redScore - state.blueScore;
+    stats->marginSum += margin;
+    stats->marginSquareSum += (double)margin * margin;
+    if (margin < stats->minMargin) stats->minMargin = margin;
+    if (margin > stats->maxMargin) stats->maxMargin = margin;
+    int bin = margin < -MARGIN_RANGE ? -MARGIN_RANGE : (margin > MARGIN_RANGE ? MARGIN_RANGE : margin);
+    stats->marginHistogram[bin + MARGIN_RANGE]++;
+}
+
+static void runExperiment(ThreadPool& pool, ExperimentResult* result) {
+    const Experiment* experiment = &result->experiment;
+    std::vector<BalanceStats> perWorker(pool.size());
+    for (BalanceStats& s : perWorker) resetStats(&s);
+
+    auto startTime = std::chrono::steady_clock::now();
+    pool.parallelForStealing(experiment->games, 16, [&](int begin, int end, int worker) {
+        for (int i = begin; i < end; i++) {
+            playBalanceGame(experiment, experiment->seed + (uint64_t)i, &perWorker[worker]);
+        }
+    });
+    result->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    resetStats(&result->stats);
+    for (const BalanceStats& s : perWorker) mergeStats(&result->stats, &s);
+}
+
+static int marginPercentile(const BalanceStats* stats, double fraction) {
+    long long target = (long long)ceil(fraction * stats->games);
+    if (target < 1) target = 1;
+    long long seen = 0;
+    for (int i = 0; i <= 2 * MARGIN_RANGE; i++) {
+        seen += stats->marginHistogram[i];
+        if (seen >= target) return i - MARGIN_RANGE;
+    }
+    return MARGIN_RANGE;
+}
+
+// 表示・出力用の派生値
+typedef struct {
+    double redWinRate;
+    double blueWinRate;
+    double tieRate;
+    double firstMoveAdvantage;   // 赤勝率 - 青勝率
+    double triggerRate;
+    double triggerSwingRate;     // 変化の時点のリード側が勝てなかった割合（同点を除く）
+    double pointsAfterTrigger;
+    double redScore;
+    double blueScore;
+    double marginMean;
+    double marginStddev;
+    int marginP10;
+    int marginP50;
+    int marginP90;
+    double plies;
+} BalanceMetrics;
+
+static void computeMetrics(const BalanceStats* s, BalanceMetrics* m) {
+    double games = s->games > 0 ? (double)s->games : 1.0;
+    long long leads = s->triggered - s->triggerTied;
+    m->redWinRate = s->redWins / games;
+    m->blueWinRate = s->blueWins / games;
+    m->tieRate = s->ties / games;
+    m->firstMoveAdvantage = m->redWinRate - m->blueWinRate;
+    m->triggerRate = s->triggered / games;
+    m->triggerSwingRate = leads > 0 ? (double)s->triggerLeaderLost / leads : 0.0;
+    m->pointsAfterTrigger = s->triggered > 0 ? s->pointsAfterTrigger / s->triggered : 0.0;
+    m->redScore = s->redScoreSum / games;
+    m->blueScore = s->blueScoreSum / games;
+    m->marginMean = s->marginSum / games;
+    double variance = s->games > 1 ? (s->marginSquareSum - games * m->marginMean * m->marginMean) / (games - 1) : 0.0;
+    m->marginStddev = variance > 0 ? sqrt(variance) : 0.0;
+    m->marginP10 = marginPercentile(s, 0.1);
+    m->marginP50 = marginPercentile(s, 0.5);
+    m->marginP90 = marginPercentile(s, 0.9);
+    m->plies = s->plies / games;
+}
+
+static bool writeCsv(const char* path, const std::vector<ExperimentResult>& results) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) return false;
+    fprintf(fp, "experiment,red,blue,games,seed,red_win,blue_win,tie,first_move_advantage,truncated,"
+                "trigger_rate,trigger_swing,points_after_trigger,red_score,blue_score,"
+                "margin_mean,margin_stddev,margin_min,margin_p10,margin_p50,margin_p90,margin_max,plies,seconds\n");
+    for (const ExperimentResult& r : results) {
+        BalanceMetrics m;
+        computeMetrics(&r.stats, &m);
+        fprintf(fp, "%s,%s,%s,%lld,%llu,%.6f,%.6f,%.6f,%.6f,%lld,%.6f,%.6f,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%d,%d,%d,%d,%.3f,%.3f\n",
+                r.experiment.name, r.experiment.redName, r.experiment.blueName, r.stats.games,
+                (unsigned long long)r.experiment.seed, m.redWinRate, m.blueWinRate, m.tieRate,
+                m.firstMoveAdvantage, r.stats.truncated, m.triggerRate, m.triggerSwingRate, m.pointsAfterTrigger,
+                m.redScore, m.blueScore, m.marginMean, m.marginStddev, r.stats.minMargin, m.marginP10,
+                m.marginP50, m.marginP90, r.stats.maxMargin, m.plies, r.seconds);
+    }
+    return fclose(fp) == 0;
+}
+
+static bool writeJson(const char* path, const std::vector<ExperimentResult>& results) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) return false;
+    fprintf(fp, "{\n  \"experiments\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const ExperimentResult& r = results[i];
+        BalanceMetrics m;
+        computeMetrics(&r.stats, &m);
+        fprintf(fp, "    {\n");
+        fprintf(fp, "      \"name\": \"%s\", \"red\": \"%s\", \"blue\": \"%s\", \"games\": %lld, \"seed\": %llu,\n",
+                r.experiment.name, r.experiment.redName, r.experiment.blueName, r.stats.games,
+                (unsigned long long)r.experiment.seed);
+        fprintf(fp, "      \"red_win\": %.6f, \"blue_win\": %.6f, \"tie\": %.6f, \"first_move_advantage\": %.6f, \"truncated\": %lld,\n",
+                m.redWinRate, m.blueWinRate, m.tieRate, m.firstMoveAdvantage, r.stats.truncated);
+        fprintf(fp, "      \"trigger\": { \"rate\": %.6f, \"swing\": %.6f, \"points_after\": %.4f },\n",
+                m.triggerRate, m.triggerSwingRate, m.pointsAfterTrigger);
+        fprintf(fp, "      \"score\": { \"red\": %.4f, \"blue\": %.4f },\n", m.redScore, m.blueScore);
+        fprintf(fp, "      \"margin\": { \"mean\": %.4f, \"stddev\": %.4f, \"min\": %d, \"p10\": %d, \"p50\": %d, \"p90\": %d, \"max\": %d },\n",
+                m.marginMean, m.marginStddev, r.stats.minMargin, m.marginP10, m.marginP50, m.marginP90, r.stats.maxMargin);
+        fprintf(fp, "      \"plies\": %.3f, \"seconds\": %.3f\n", m.plies, r.seconds);
+        fprintf(fp, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    return fclose(fp) == 0;
+}
+
+int main(int argc, char** argv) {
+    const char* configPath = NULL;
+    const char* csvPath = NULL;
+    const char* jsonPath = NULL;
+    int threads = 0;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--csv") == 0 && hasValue) {
+            csvPath = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && !configPath) {
+            configPath = argv[i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (!configPath) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<Experiment> experiments;
+    if (!loadExperiments(configPath, &experiments)) return 1;
+
+    ThreadPool pool(threads);
+    printf("%zu experiments, %d threads\n\n", experiments.size(), pool.size());
+    printf("%-18s %-10s %-10s %9s %7s %7s %7s %8s %7s %7s %14s %7s\n", "experiment", "red", "blue", "games",
+           "red", "blue", "tie", "1st-adv", "+2", "swing", "margin", "plies");
+
+    std::vector<ExperimentResult> results(experiments.size());
+    for (size_t i = 0; i < experiments.size(); i++) {
+        results[i].experiment = experiments[i];
+        runExperiment(pool, &results[i]);
+
+        BalanceMetrics m;
+        computeMetrics(&results[i].stats, &m);
+        printf("%-18s %-10s %-10s %9lld %6.1f%% %6.1f%% %6.1f%% %+7.1f%% %6.1f%% %6.1f%% %7.2f±%-6.2f %7.1f\n",
+               experiments[i].name, experiments[i].redName, experiments[i].blueName, results[i].stats.games,
+               100.0 * m.redWinRate, 100.0 * m.blueWinRate, 100.0 * m.tieRate, 100.0 * m.firstMoveAdvantage,
+               100.0 * m.triggerRate, 100.0 * m.triggerSwingRate, m.marginMean, m.marginStddev, m.plies);
+        fflush(stdout);
+    }
+
+    if (csvPath && !writeCsv(csvPath, results)) {
+        fprintf(stderr, "CSVを書き込めません: %s\n", csvPath);
+        return 1;
+    }
+    if (jsonPath && !writeJson(jsonPath, results)) {
+        fprintf(stderr, "JSONを書き込めません: %s\n", jsonPath);
+        return 1;
+    }
+    return 0;
+}
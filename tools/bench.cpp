@@ -0,0 +1,521 @@
+// ルール・AI・描画（CPU側）のマイクロベンチマーク
+//   puzzle_bench [--filter 名前の一部] [--samples 30] [--min-time 20] [--csv out.csv] [--json out.json]
+//                [--compare base.csv] [--threshold 10]
+//
+// 各項目は1サンプルが --min-time ミリ秒以上になるよう反復回数を決め、--samples 回測って
+// 1回あたりの時間（ns）の平均・標準偏差・最小・中央値・最大を出す
+// 描画は glad の関数ポインタを数えるだけの関数に差し替えて renderGame の CPU 側だけを測る
+// --compare には以前の --csv を渡し、中央値が --threshold % を超えて遅くなった項目があれば終了コード 1
+#include <glad/gl.h>
+#include "renderer.h"
+#include "match.h"
+#include "vec_env.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#define BENCH_POSITIONS 1024   // 測定に使う局面の数（ランダム対局の途中局面）
+
+typedef struct {
+    char name[32];
+    long long iterations;      // 1サンプルあたりの反復回数
+    double mean;               // ns/回
+    double stddev;
+    double min;
+    double median;
+    double max;
+    double glCalls;            // 1回あたりのGL呼び出し数（描画のみ）
+    double drawCalls;
+    double uploadBytes;
+    double elidedCalls;        // GL状態キャッシュが省いた呼び出し数
+} BenchResult;
+
+typedef struct {
+    const char* filter;
+    int samples;
+    double minTime;            // 秒
+    const char* csvPath;
+    const char* jsonPath;
+    const char* comparePath;
+    double threshold;          // %
+} BenchOptions;
+
+// 測定対象の結果を捨てさせないための出口
+static volatile uint64_t benchSink;
+
+// ---- GL呼び出しの差し替え ----
+
+static long long stubCalls = 0;
+static long long stubDrawCalls = 0;
+static long long stubUploadBytes = 0;
+
+static void GLAD_API_PTR stubUseProgram(GLuint) { stubCalls++; }
+static void GLAD_API_PTR stubBindVertexArray(GLuint) { stubCalls++; }
+static void GLAD_API_PTR stubBindBuffer(GLenum, GLuint) { stubCalls++; }
+static void GLAD_API_PTR stubBindTexture(GLenum, GLuint) { stubCalls++; }
+static void GLAD_API_PTR stubEnable(GLenum) { stubCalls++; }
+static void GLAD_API_PTR stubDisable(GLenum) { stubCalls++; }
+static void GLAD_API_PTR stubBlendFunc(GLenum, GLenum) { stubCalls++; }
+static void GLAD_API_PTR stubEnableVertexAttribArray(GLuint) { stubCalls++; }
+static void GLAD_API_PTR stubVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) { stubCalls++; }
+static void GLAD_API_PTR stubVertexAttribIPointer(GLuint, GLint, GLenum, GLsizei, const void*) { stubCalls++; }
+static void GLAD_API_PTR stubVertexAttribDivisor(GLuint, GLuint) { stubCalls++; }
+static void GLAD_API_PTR stubUniform1i(GLint, GLint) { stubCalls++; }
+static void GLAD_API_PTR stubUniform1f(GLint, GLfloat) { stubCalls++; }
+static void GLAD_API_PTR stubUniform2f(GLint, GLfloat, GLfloat) { stubCalls++; }
+static void GLAD_API_PTR stubUniform4fv(GLint, GLsizei, const GLfloat*) { stubCalls++; }
+
+static GLint GLAD_API_PTR stubGetUniformLocation(GLuint, const GLchar*) {
+    stubCalls++;
+    return 0;
+}
+
+static void GLAD_API_PTR stubActiveTexture(GLenum) { stubCalls++; }
+static void GLAD_API_PTR stubTexParameteri(GLenum, GLenum, GLint) { stubCalls++; }
+static void GLAD_API_PTR stubDeleteTextures(GLsizei, const GLuint*) { stubCalls++; }
+
+// 作成系は通し番号を返す
+static GLuint stubNextName = 1;
+
+static void GLAD_API_PTR stubGenNames(GLsizei n, GLuint* names) {
+    stubCalls++;
+    for (GLsizei i = 0; i < n; i++) names[i] = stubNextName++;
+}
+
+static void GLAD_API_PTR stubBufferData(GLenum, GLsizeiptr size, const void* data, GLenum) {
+    stubCalls++;
+    if (data) stubUploadBytes += size;
+}
+
+// 頂点リングバッファの写像（GL 3.3 の経路）は書き込み先を渡し、写像した長さを転送量として数える
+static unsigned char stubMappedMemory[1 << 20];
+
+static void* GLAD_API_PTR stubMapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield) {
+    stubCalls++;
+    stubUploadBytes += length;
+    return length <= (GLsizeiptr)sizeof(stubMappedMemory) ? stubMappedMemory : NULL;
+}
+
+static GLboolean GLAD_API_PTR stubUnmapBuffer(GLenum) {
+    stubCalls++;
+    return GL_TRUE;
+}
+
+static void GLAD_API_PTR stubTexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum,
+                                         GLenum, const void* pixels) {
+    stubCalls++;
+    if (pixels) stubUploadBytes += (long long)width * height;
+}
+
+static void GLAD_API_PTR stubBufferSubData(GLenum, GLintptr, GLsizeiptr size, const void*) {
+    stubCalls++;
+    stubUploadBytes += size;
+}
+
+static void GLAD_API_PTR stubDrawArrays(GLenum, GLint, GLsizei) {
+    stubCalls++;
+    stubDrawCalls++;
+}
+
+static void GLAD_API_PTR stubDrawArraysInstanced(GLenum, GLint, GLsizei, GLsizei) {
+    stubCalls++;
+    stubDrawCalls++;
+}
+
+static void GLAD_API_PTR stubGetIntegerv(GLenum, GLint* data) {
+    stubCalls++;
+    *data = 0;
+}
+
+static const GLubyte* GLAD_API_PTR stubGetString(GLenum name) {
+    return (const GLubyte*)(name == GL_VERSION ? "3.3.0 puzzle_bench" : "");
+}
+
+static const struct {
+    const char* name;
+    GLADapiproc proc;
+} kGlStubs[] = {
+    {"glGetString", (GLADapiproc)stubGetString},
+    {"glGetIntegerv", (GLADapiproc)stubGetIntegerv},
+    {"glUseProgram", (GLADapiproc)stubUseProgram},
+    {"glBindVertexArray", (GLADapiproc)stubBindVertexArray},
+    {"glBindBuffer", (GLADapiproc)stubBindBuffer},
+    {"glBindTexture", (GLADapiproc)stubBindTexture},
+    {"glEnable", (GLADapiproc)stubEnable},
+    {"glDisable", (GLADapiproc)stubDisable},
+    {"glBlendFunc", (GLADapiproc)stubBlendFunc},
+    {"glEnableVertexAttribArray", (GLADapiproc)stubEnableVertexAttribArray},
+    {"glVertexAttribPointer", (GLADapiproc)stubVertexAttribPointer},
+    {"glActiveTexture", (GLADapiproc)stubActiveTexture},
+    {"glGenVertexArrays", (GLADapiproc)stubGenNames},
+    {"glGenBuffers", (GLADapiproc)stubGenNames},
+    {"glGenTextures", (GLADapiproc)stubGenNames},
+    {"glDeleteTextures", (GLADapiproc)stubDeleteTextures},
+    {"glTexImage2D", (GLADapiproc)stubTexImage2D},
+    {"glTexParameteri", (GLADapiproc)stubTexParameteri},
+    {"glBufferData", (GLADapiproc)stubBufferData},
+    {"glBufferSubData", (GLADapiproc)stubBufferSubData},
+    {"glMapBufferRange", (GLADapiproc)stubMapBufferRange},
+    {"glUnmapBuffer", (GLADapiproc)stubUnmapBuffer},
+    {"glDrawArrays", (GLADapiproc)stubDrawArrays},
+    {"glDrawArraysInstanced", (GLADapiproc)stubDrawArraysInstanced},
+    {"glVertexAttribIPointer", (GLADapiproc)stubVertexAttribIPointer},
+    {"glVertexAttribDivisor", (GLADapiproc)stubVertexAttribDivisor},
+    {"glGetUniformLocation", (GLADapiproc)stubGetUniformLocation},
+    {"glUniform1i", (GLADapiproc)stubUniform1i},
+    {"glUniform1f", (GLADapiproc)stubUniform1f},
+    {"glUniform2f", (GLADapiproc)stubUniform2f},
+    {"glUniform4fv", (GLADapiproc)stubUniform4fv},
+};
+
+// 差し替えのない関数は NULL のまま（描画が新しい関数を使い始めたらここに足す）
+static GLADapiproc loadGlStub(const char* name) {
+    for (size_t i = 0; i < sizeof(kGlStubs) / sizeof(kGlStubs[0]); i++) {
+        if (strcmp(kGlStubs[i].name, name) == 0) return kGlStubs[i].proc;
+    }
+    return NULL;
+}
+
+// ---- 測定 ----
+
+static double percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+// body(n) は n 回分の処理を行う。反復回数を倍々に増やして1サンプルの長さを決めてから測る
+static BenchResult runBenchmark(const BenchOptions* opt, const char* name,
+                                const std::function<void(long long)>& body) {
+    typedef std::chrono::steady_clock Clock;
+    BenchResult result;
+    memset(&result, 0, sizeof(result));
+    snprintf(result.name, sizeof(result.name), "%s", name);
+
+    long long iterations = 1;
+    for (;;) {
+        auto start = Clock::now();
+        body(iterations);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= opt->minTime || iterations >= (1LL << 40)) break;
+        iterations *= 2;
+    }
+    result.iterations = iterations;
+
+    stubCalls = stubDrawCalls = stubUploadBytes = 0;
+    long long elidedBefore = getGlStateStats()->elided;
+    std::vector<double> samples;
+    for (int s = 0; s < opt->samples; s++) {
+        auto start = Clock::now();
+        body(iterations);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        samples.push_back(1e9 * seconds / iterations);
+    }
+
+    double sum = 0.0, squareSum = 0.0;
+    for (double v : samples) {
+        sum += v;
+        squareSum += v * v;
+    }
+    int n = (int)samples.size();
+    result.mean = sum / n;
+    double variance = n > 1 ? (squareSum - n * result.mean * result.mean) / (n - 1) : 0.0;
+    result.stddev = variance > 0 ? sqrt(variance) : 0.0;
+    result.min = *std::min_element(samples.begin(), samples.end());
+    result.max = *std::max_element(samples.begin(), samples.end());
+    result.median = percentile(samples, 0.5);
+
+    double total = (double)iterations * n;
+    result.glCalls = stubCalls / total;
+    result.drawCalls = stubDrawCalls / total;
+    result.uploadBytes = stubUploadBytes / total;
+    result.elidedCalls = (getGlStateStats()->elided - elidedBefore) / total;
+    return result;
+}
+
+// ランダム対局の途中局面（終局前）と、そこで選べる列を1つずつ集める
+static void collectPositions(std::vector<GameState>* states, std::vector<int>* columns) {
+    uint64_t x = 0x2545F4914F6CDD1DULL;
+    uint64_t seed = 1;
+    GameState state;
+    memset(&state, 0, sizeof(state));
+    while ((int)states->size() < BENCH_POSITIONS) {
+        seedGame(&state, seed++);
+        resetGame(&state);
+        while (!state.gameOver && state.plies < MATCH_MAX_PLIES && (int)states->size() < BENCH_POSITIONS) {
+            int selectable[BOARD_SIZE], count = 0;
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                if (isColumnSelectable(&state, col)) selectable[count++] = col;
+            }
+            if (count == 0) break;
+            x ^= x >> 12;
+            x ^= x << 25;
+            x ^= x >> 27;
+            int col = selectable[(x * 0x2545F4914F6CDD1DULL >> 33) % count];
+            states->push_back(state);
+            columns->push_back(col);
+            playMove(&state, col);
+        }
+    }
+}
+
+static std::vector<BenchResult> runAll(const BenchOptions* opt) {
+    std::vector<GameState> states;
+    std::vector<int> columns;
+    collectPositions(&states, &columns);
+
+    std::vector<BenchResult> results;
+    auto add = [&](const char* name, const std::function<void(long long)>& body) {
+        if (opt->filter && !strstr(name, opt->filter)) return;
+        results.push_back(runBenchmark(opt, name, body));
+        const BenchResult& r = results.back();
+        fprintf(stderr, "%-20s %12.1f ns/op\n", r.name, r.median);
+    };
+
+    add("select_column", [&](long long n) {
+        GameState scratch;
+        uint64_t sink = 0;
+        for (long long i = 0; i < n; i++) {
+            int k = (int)(i % BENCH_POSITIONS);
+            scratch = states[k];
+            sink += selectColumn(&scratch, columns[k]);
+            sink += (uint64_t)scratch.redScore;
+        }
+        benchSink = sink;
+    });
+
+    add("calculate_score", [&](long long n) {
+        uint64_t sink = 0;
+        for (long long i = 0; i < n; i++) {
+            GameState* s = &states[i % BENCH_POSITIONS];
+            calculateScore(s);
+            sink += (uint64_t)(s->redScore - s->blueScore);
+        }
+        benchSink = sink;
+    });
+
+    add("best_column_for_blue", [&](long long n) {
+        uint64_t sink = 0;
+        for (long long i = 0; i < n; i++) {
+            sink += (uint64_t)getBestColumnForBlue(&states[i % BENCH_POSITIONS]);
+        }
+        benchSink = sink;
+    });
+
+    add("init_board", [&](long long n) {
+        GameState scratch = states[0];
+        uint64_t sink = 0;
+        for (long long i = 0; i < n; i++) {
+            initBoard(&scratch);
+            sink += (uint64_t)scratch.board[i % BOARD_SIZE][0];
+        }
+        benchSink = sink;
+    });
+
+    add("random_game", [&](long long n) {
+        Controller random;
+        parseController("random", &random);
+        static uint64_t seed = 1;
+        uint64_t sink = 0;
+        for (long long i = 0; i < n; i++) {
+            MatchResult result;
+            playMatch(&random, &random, seed++, &result);
+            sink += (uint64_t)result.plies;
+        }
+        benchSink = sink;
+    });
+
+    // 強化学習環境: 1回 = 1環境の1手（1024環境をまとめて呼び出し元スレッドだけで進める）
+    add("vec_env_step", [&](long long n) {
+        const int count = 1024;
+        static VecEnv env;
+        static std::vector<int8_t> board(count * BOARD_SIZE * BOARD_SIZE), columnStates(count * BOARD_SIZE);
+        static std::vector<int32_t> scores(count * 2);
+        static std::vector<uint8_t> plusTwo(count), currentPlayer(count), legal(count * BOARD_SIZE), dones(count);
+        static std::vector<float> rewards(count);
+        static std::vector<int> actions(count);
+        VecEnvBuffers out = {board.data(), columnStates.data(), scores.data(), plusTwo.data(),
+                             currentPlayer.data(), legal.data(), rewards.data(), dones.data()};
+        if (env.states.empty()) {
+            VecEnvConfig config = {count, 1, NULL, NULL, PLAYER_RED, 1};
+            initVecEnv(&env, &config);
+            resetVecEnv(&env, &out);
+        }
+        uint64_t sink = 0;
+        for (long long done = 0; done < n; done += count) {
+            for (int i = 0; i < count; i++) actions[i] = (int)((i + done / count) % BOARD_SIZE);
+            stepVecEnv(&env, actions.data(), &out);
+            sink += dones[0];
+        }
+        benchSink = sink;
+    });
+
+    // 描画: 途中局面を順にゲームの状態へ写して1フレーム分を組み立てる
+    // （毎フレーム局面が変わった扱いにするため revision を進める）
+    add("render_frame", [&](long long n) {
+        GameState* game = getGameState();
+        static uint32_t revision = 0;
+        for (long long i = 0; i < n; i++) {
+            *game = states[i % BENCH_POSITIONS];
+            game->effectState = NO_EFFECT;
+            game->revision = ++revision;
+            renderGame();
+        }
+    });
+
+    // 描画: 局面が変わらないフレーム（盤面の転送は0バイトになる）
+    add("render_frame_idle", [&](long long n) {
+        GameState* game = getGameState();
+        *game = states[0];
+        game->effectState = NO_EFFECT;
+        for (long long i = 0; i < n; i++) {
+            renderGame();
+        }
+    });
+    return results;
+}
+
+// ---- 出力 ----
+
+static void printResults(const std::vector<BenchResult>& results) {
+    printf("%-20s %12s %12s %10s %12s %12s %8s %8s %10s %9s\n", "benchmark", "iterations", "median ns",
+           "stddev", "min ns", "max ns", "gl/op", "draw/op", "bytes/op", "elided/op");
+    for (const BenchResult& r : results) {
+        printf("%-20s %12lld %12.1f %10.1f %12.1f %12.1f %8.1f %8.1f %10.1f %9.1f\n", r.name, r.iterations,
+               r.median, r.stddev, r.min, r.max, r.glCalls, r.drawCalls, r.uploadBytes, r.elidedCalls);
+    }
+}
+
+static bool writeCsv(const char* path, const std::vector<BenchResult>& results) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) return false;
+    fprintf(fp, "benchmark,iterations,mean_ns,stddev_ns,min_ns,median_ns,max_ns,gl_calls,draw_calls,upload_bytes,elided_calls\n");
+    for (const BenchResult& r : results) {
+        fprintf(fp, "%s,%lld,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", r.name, r.iterations, r.mean,
+                r.stddev, r.min, r.median, r.max, r.glCalls, r.drawCalls, r.uploadBytes, r.elidedCalls);
+    }
+    return fclose(fp) == 0;
+}
+
+static bool writeJson(const char* path, const std::vector<BenchResult>& results) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) return false;
+    fprintf(fp, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(fp, "    { \"name\": \"%s\", \"iterations\": %lld, \"mean_ns\": %.3f, \"stddev_ns\": %.3f, "
+                    "\"min_ns\": %.3f, \"median_ns\": %.3f, \"max_ns\": %.3f, "
+                    "\"gl_calls\": %.3f, \"draw_calls\": %.3f, \"upload_bytes\": %.3f, \"elided_calls\": %.3f }%s\n",
+                r.name, r.iterations, r.mean, r.stddev, r.min, r.median, r.max, r.glCalls, r.drawCalls,
+                r.uploadBytes, r.elidedCalls, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    return fclose(fp) == 0;
+}
+
+// 以前の CSV と中央値を比べ、閾値を超えて遅くなった項目の数を返す（読めなければ -1）
+static int compareWithBaseline(const char* path, const std::vector<BenchResult>& results, double threshold) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) return -1;
+    char line[512];
+    int regressions = 0;
+    bool header = true;
+    while (fgets(line, sizeof(line), fp)) {
+        if (header) {
+            header = false;
+            continue;
+        }
+        // benchmark,iterations,mean_ns,stddev_ns,min_ns,median_ns,...
+        char name[32];
+        long long iterations;
+        double mean, stddev, min, median;
+        if (sscanf(line, "%31[^,],%lld,%lf,%lf,%lf,%lf", name, &iterations, &mean, &stddev, &min, &median) != 6) continue;
+        for (const BenchResult& r : results) {
+            if (strcmp(r.name, name) != 0 || median <= 0.0) continue;
+            double change = 100.0 * (r.median - median) / median;
+            bool regressed = change > threshold;
+            if (regressed) regressions++;
+            printf("%-20s %12.1f -> %12.1f ns  %+7.1f%%%s\n", name, median, r.median, change,
+                   regressed ? "  REGRESSION" : "");
+        }
+    }
+    fclose(fp);
+    return regressions;
+}
+
+static void printUsage() {
+    printf("usage: puzzle_bench [--filter NAME] [--samples N] [--min-time MS] [--csv <file>] [--json <file>]\n");
+    printf("                    [--compare <baseline.csv>] [--threshold PERCENT]\n");
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    opt.filter = NULL;
+    opt.samples = 30;
+    opt.minTime = 0.02;
+    opt.csvPath = NULL;
+    opt.jsonPath = NULL;
+    opt.comparePath = NULL;
+    opt.threshold = 10.0;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            opt.filter = argv[++i];
+        } else if (strcmp(argv[i], "--samples") == 0 && hasValue) {
+            opt.samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--min-time") == 0 && hasValue) {
+            opt.minTime = atof(argv[++i]) / 1000.0;
+        } else if (strcmp(argv[i], "--csv") == 0 && hasValue) {
+            opt.csvPath = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            opt.jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && hasValue) {
+            opt.comparePath = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && hasValue) {
+            opt.threshold = atof(argv[++i]);
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (opt.samples < 1) opt.samples = 1;
+
+    // 描画の準備: GL関数を差し替え、アイコンの描画も通るようにアトラスの番号と範囲だけ入れておく
+    // （シェーダは作らない。頂点配列・バッファの作成とフォントの読み込みは通す）
+    if (!gladLoadGL(loadGlStub)) {
+        fprintf(stderr, "GL関数を差し替えられません\n");
+        return 2;
+    }
+    atlasTexture = 1;
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        atlasRegions[i] = AtlasRegion{(float)i / SPRITE_COUNT, 0.0f, (float)(i + 1) / SPRITE_COUNT, 1.0f, true};
+    }
+    setupFont();
+    setupGameRenderer();
+
+    std::vector<BenchResult> results = runAll(&opt);
+    printResults(results);
+
+    if (opt.csvPath && !writeCsv(opt.csvPath, results)) {
+        fprintf(stderr, "CSVを書き込めません: %s\n", opt.csvPath);
+        return 2;
+    }
+    if (opt.jsonPath && !writeJson(opt.jsonPath, results)) {
+        fprintf(stderr, "JSONを書き込めません: %s\n", opt.jsonPath);
+        return 2;
+    }
+    if (opt.comparePath) {
+        int regressions = compareWithBaseline(opt.comparePath, results, opt.threshold);
+        if (regressions < 0) {
+            fprintf(stderr, "比較用のCSVを読めません: %s\n", opt.comparePath);
+            return 2;
+        }
+        return regressions > 0 ? 1 : 0;
+    }
+    return 0;
+}
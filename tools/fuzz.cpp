@@ -0,0 +1,585 @@
+// ルールの差分ファジング
+//   puzzle_fuzz [--cases 100000] [--max-ops 200] [--seed 1] [--threads 0] [--replay <repro>] [--mutate]
+//
+// 元の game.cpp のルール（グローバル状態・rand() を乱数に差し替えただけの写し）を参照実装として、
+// ライブラリのルール関数と同じ操作列で並走させ、操作ごとに状態全体を比べる
+//   - selectColumn（範囲外・塗れない列も含む）、playMove、applyPlusTwoChange、calculateScore
+//   - getBestColumnForBlue（表引き）と getBestColumnsForBlue（まとめて）を元の比較ループと
+//   - playMove の手は探索用局面（applySearchMove + applyRerollClass）とも
+// 食い違いが見つかったら操作列を縮めて最小の再現手順を表示する（--replay でそのまま再実行できる）
+// --mutate は参照実装にわざと誤りを入れて、このハーネス自体が食い違いを検出できるかを確かめる
+#include "ai.h"
+#include "search.h"
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ---- 参照実装（元の game.cpp から。演出の時刻とAI待機は持たない） ----
+
+typedef struct {
+    CellValue board[BOARD_SIZE][BOARD_SIZE];
+    ColumnState columnStates[BOARD_SIZE];
+    Player currentPlayer;
+    int redScore;
+    int blueScore;
+    bool gameOver;
+    int paintedColumns;
+    EffectState effectState;
+    bool plusTwoTriggered;
+    uint64_t rngState;
+} RefState;
+
+static bool mutateReference = false;
+
+// rand() の代わり（ライブラリと同じ splitmix64 + xorshift64*）
+static void refSeed(RefState* s, uint64_t seed) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    s->rngState = z ? z : 0x2545F4914F6CDD1DULL;
+}
+
+static uint32_t refRand(RefState* s) {
+    uint64_t x = s->rngState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    s->rngState = x;
+    return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static void refInitBoard(RefState* s) {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            int randVal = refRand(s) % 3;
+            switch (randVal) {
+                case 0: s->board[i][j] = INVALID; break;
+                case 1: s->board[i][j] = PLUS_ONE; break;
+                case 2: s->board[i][j] = MINUS_ONE; break;
+            }
+        }
+    }
+}
+
+static void refResetGame(RefState* s) {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        s->columnStates[i] = EMPTY;
+    }
+    s->currentPlayer = PLAYER_RED;
+    s->redScore = 0;
+    s->blueScore = 0;
+    s->gameOver = false;
+    s->paintedColumns = 0;
+    s->effectState = NO_EFFECT;
+    s->plusTwoTriggered = false;
+    refInitBoard(s);
+}
+
+static int refCountUnpaintedColumns(const RefState* s) {
+    int count = 0;
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        if (s->columnStates[i] == EMPTY) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void refTriggerPlusTwoEffect(RefState* s) {
+    if (s->plusTwoTriggered) return;
+    s->plusTwoTriggered = true;
+    s->effectState = EFFECT_WAITING;
+}
+
+static void refApplyPlusTwoChange(RefState* s) {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            if (s->board[i][j] == PLUS_ONE) {
+                s->board[i][j] = PLUS_TWO;
+            }
+        }
+    }
+}
+
+static bool refIsGameOver(const RefState* s) {
+    return s->paintedColumns >= BOARD_SIZE;
+}
+
+static void refSwitchPlayer(RefState* s) {
+    s->currentPlayer = (s->currentPlayer == PLAYER_RED) ? PLAYER_BLUE : PLAYER_RED;
+}
+
+static bool refSelectColumn(RefState* s, int col) {
+    if (col < 0 || col >= BOARD_SIZE) return false;
+
+    if (s->columnStates[col] == PAINTED_RED && s->currentPlayer != PLAYER_BLUE) return false;
+    if (s->columnStates[col] == PAINTED_BLUE && s->currentPlayer != PLAYER_RED) return false;
+
+    bool firstPaint = (s->columnStates[col] == EMPTY);
+
+    if (s->currentPlayer == PLAYER_RED) {
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            if (s->board[i][col] == PLUS_ONE) {
+                s->redScore++;
+            } else if (s->board[i][col] == PLUS_TWO) {
+                s->redScore += mutateReference ? 1 : 2;
+            } else if (s->board[i][col] == MINUS_ONE) {
+                s->blueScore--;
+            }
+        }
+    } else {
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            if (s->board[i][col] == PLUS_ONE) {
+                s->blueScore++;
+            } else if (s->board[i][col] == PLUS_TWO) {
+                s->blueScore += 2;
+            } else if (s->board[i][col] == MINUS_ONE) {
+                s->redScore--;
+            }
+        }
+    }
+
+    if (s->currentPlayer == PLAYER_RED) {
+        s->columnStates[col] = PAINTED_RED;
+    } else {
+        s->columnStates[col] = PAINTED_BLUE;
+    }
+    if (firstPaint) s->paintedColumns++;
+
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        int randVal = refRand(s) % 3;
+        switch (randVal) {
+            case 0: s->board[i][col] = INVALID; break;
+            case 1:
+                s->board[i][col] = s->plusTwoTriggered ? PLUS_TWO : PLUS_ONE;
+                break;
+            case 2: s->board[i][col] = MINUS_ONE; break;
+        }
+    }
+
+    if (refCountUnpaintedColumns(s) == 3 && !s->plusTwoTriggered) {
+        refTriggerPlusTwoEffect(s);
+    }
+
+    if (refIsGameOver(s)) {
+        s->gameOver = true;
+    } else {
+        refSwitchPlayer(s);
+    }
+    return true;
+}
+
+static void refCalculateScore(RefState* s) {
+    s->redScore = 0;
+    s->blueScore = 0;
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        if (s->columnStates[i] == PAINTED_RED) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                if (s->board[j][i] == PLUS_ONE) {
+                    s->redScore++;
+                } else if (s->board[j][i] == PLUS_TWO) {
+                    s->redScore += 2;
+                } else if (s->board[j][i] == MINUS_ONE) {
+                    s->blueScore--;
+                }
+            }
+        } else if (s->columnStates[i] == PAINTED_BLUE) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                if (s->board[j][i] == PLUS_ONE) {
+                    s->blueScore++;
+                } else if (s->board[j][i] == PLUS_TWO) {
+                    s->blueScore += 2;
+                } else if (s->board[j][i] == MINUS_ONE) {
+                    s->redScore--;
+                }
+            }
+        }
+    }
+}
+
+static int refGetBestColumnForBlue(const RefState* s) {
+    int bestColumn = -1;
+    int minInvalidCells = BOARD_SIZE + 1;
+    int bestScore = -1000;
+
+    int unpaintedCount = refCountUnpaintedColumns(s);
+    if (unpaintedCount == 1 && s->blueScore > s->redScore) {
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            if (s->columnStates[col] == EMPTY) {
+                return col;
+            }
+        }
+    }
+
+    for (int col = 0; col < BOARD_SIZE; col++) {
+        if (s->columnStates[col] == PAINTED_BLUE && s->currentPlayer != PLAYER_RED) continue;
+        if (s->columnStates[col] == PAINTED_RED && s->currentPlayer != PLAYER_BLUE) continue;
+
+        int invalidCount = 0;
+        int currentScore = 0;
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            if (s->board[j][col] == INVALID) {
+                invalidCount++;
+            } else if (s->board[j][col] == PLUS_ONE) {
+                currentScore += 1;
+            } else if (s->board[j][col] == PLUS_TWO) {
+                currentScore += 2;
+            } else if (s->board[j][col] == MINUS_ONE) {
+                currentScore -= 1;
+            }
+        }
+
+        bool isBetter = false;
+        if (invalidCount < minInvalidCells) {
+            isBetter = true;
+        } else if (invalidCount == minInvalidCells && currentScore > bestScore) {
+            isBetter = true;
+        }
+
+        if (isBetter) {
+            bestColumn = col;
+            minInvalidCells = invalidCount;
+            bestScore = currentScore;
+        }
+    }
+
+    return bestColumn;
+}
+
+// ---- 操作列 ----
+
+enum FuzzOpKind {
+    OP_SELECT = 0,      // selectColumn（+2変化は演出待ちのまま）
+    OP_PLAY = 1,        // playMove（+2変化まで即時）
+    OP_APPLY = 2,       // 演出が終わったときの applyPlusTwoChange
+    OP_RESCORE = 3,     // calculateScore
+    OP_KIND_COUNT = 4
+};
+
+typedef struct {
+    uint8_t kind;
+    int8_t col;         // -1..6（範囲外も試す）
+} FuzzOp;
+
+typedef struct {
+    uint64_t seed;
+    std::vector<FuzzOp> ops;
+} FuzzCase;
+
+static uint64_t mixSeed(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static void generateCase(uint64_t seed, int maxOps, FuzzCase* fc) {
+    fc->seed = seed;
+    fc->ops.clear();
+    uint64_t x = mixSeed(seed ^ 0xF022ULL);
+    int count = 1 + (int)(x % (uint64_t)maxOps);
+    for (int i = 0; i < count; i++) {
+        x = mixSeed(x);
+        FuzzOp op;
+        int r = (int)(x % 100);
+        // 手を打つ操作を多めに、たまに演出の反映や再計算を挟む
+        op.kind = r < 45 ? OP_SELECT : (r < 85 ? OP_PLAY : (r < 95 ? OP_APPLY : OP_RESCORE));
+        op.col = (int8_t)((int)((x >> 8) % 8) - 1);
+        fc->ops.push_back(op);
+    }
+}
+
+// ---- 比較 ----
+
+static bool sameState(const GameState* g, const RefState* r, char* why, size_t whySize) {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            if (g->board[i][j] != r->board[i][j]) {
+                snprintf(why, whySize, "board[%d][%d] %d != %d", i, j, g->board[i][j], r->board[i][j]);
+                return false;
+            }
+        }
+        if (g->columnStates[i] != r->columnStates[i]) {
+            snprintf(why, whySize, "columnStates[%d] %d != %d", i, g->columnStates[i], r->columnStates[i]);
+            return false;
+        }
+    }
+    if (g->currentPlayer != r->currentPlayer) { snprintf(why, whySize, "currentPlayer %d != %d", g->currentPlayer, r->currentPlayer); return false; }
+    if (g->redScore != r->redScore) { snprintf(why, whySize, "redScore %d != %d", g->redScore, r->redScore); return false; }
+    if (g->blueScore != r->blueScore) { snprintf(why, whySize, "blueScore %d != %d", g->blueScore, r->blueScore); return false; }
+    if (g->gameOver != r->gameOver) { snprintf(why, whySize, "gameOver %d != %d", g->gameOver, r->gameOver); return false; }
+    if (g->paintedColumns != r->paintedColumns) { snprintf(why, whySize, "paintedColumns %d != %d", g->paintedColumns, r->paintedColumns); return false; }
+    if (g->plusTwoTriggered != r->plusTwoTriggered) { snprintf(why, whySize, "plusTwoTriggered %d != %d", g->plusTwoTriggered, r->plusTwoTriggered); return false; }
+    if (g->effectState != r->effectState) { snprintf(why, whySize, "effectState %d != %d", g->effectState, r->effectState); return false; }
+    if (g->rngState != r->rngState) { snprintf(why, whySize, "rngState differs"); return false; }
+    return true;
+}
+
+static int findRerollClass(const GameState* g, int col) {
+    int invalid = 0, plus = 0, minus = 0;
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        CellValue v = g->board[i][col];
+        if (v == INVALID) invalid++;
+        else if (v == MINUS_ONE) minus++;
+        else plus++;
+    }
+    const RerollClass* classes = getRerollClasses();
+    for (int k = 0; k < REROLL_CLASS_COUNT; k++) {
+        if (classes[k].invalidCount == invalid && classes[k].plusCount == plus && classes[k].minusCount == minus) return k;
+    }
+    return -1;
+}
+
+static bool samePosition(const SearchPosition* a, const SearchPosition* b) {
+    return memcmp(a->columns, b->columns, sizeof(a->columns)) == 0 && a->redScore == b->redScore &&
+           a->blueScore == b->blueScore && a->currentPlayer == b->currentPlayer &&
+           a->paintedColumns == b->paintedColumns && a->plusTwoTriggered == b->plusTwoTriggered &&
+           a->gameOver == b->gameOver;
+}
+
+// 操作列を並走させる。食い違えばその操作の番号（なければ -1）と理由を返す
+static int runCase(const FuzzCase* fc, long long* moves, char* why, size_t whySize) {
+    GameState g;
+    memset(&g, 0, sizeof(g));
+    seedGame(&g, fc->seed);
+    resetGame(&g);
+    RefState r;
+    memset(&r, 0, sizeof(r));
+    refSeed(&r, fc->seed);
+    refResetGame(&r);
+    if (!sameState(&g, &r, why, whySize)) return 0;
+
+    for (int i = 0; i < (int)fc->ops.size(); i++) {
+        const FuzzOp& op = fc->ops[i];
+        if (g.gameOver) {
+            // 終局後はどちらも作り直して続ける
+            resetGame(&g);
+            refResetGame(&r);
+        }
+
+        // 手の前に貪欲AIの選択を比べる
+        int expected = refGetBestColumnForBlue(&r);
+        int actual = getBestColumnForBlue(&g);
+        int batch = -2;
+        getBestColumnsForBlue(&g, 1, &batch);
+        if (actual != expected || batch != expected) {
+            snprintf(why, whySize, "getBestColumnForBlue %d (batch %d) != %d", actual, batch, expected);
+            return i;
+        }
+
+        bool gotResult = true, refResult = true;
+        switch (op.kind) {
+            case OP_SELECT:
+                gotResult = selectColumn(&g, op.col);
+                refResult = refSelectColumn(&r, op.col);
+                break;
+            case OP_PLAY: {
+                // 演出待ちの局面は探索用局面では表せないので、反映済みの局面からの手だけ比べる
+                bool comparable = (g.effectState == NO_EFFECT);
+                SearchPosition expectedPos, actualPos;
+                makeSearchPosition(&g, &expectedPos);
+                gotResult = playMove(&g, op.col);
+                refResult = refSelectColumn(&r, op.col);
+                if (refResult && r.effectState != NO_EFFECT) {
+                    refApplyPlusTwoChange(&r);
+                    r.effectState = NO_EFFECT;
+                }
+                if (gotResult && comparable && applySearchMove(&expectedPos, op.col)) {
+                    applyRerollClass(&expectedPos, op.col, findRerollClass(&g, op.col));
+                    makeSearchPosition(&g, &actualPos);
+                    if (!samePosition(&expectedPos, &actualPos)) {
+                        snprintf(why, whySize, "search position differs after playMove(%d)", op.col);
+                        return i;
+                    }
+                }
+                break;
+            }
+            case OP_APPLY:
+                if (g.effectState != NO_EFFECT) {
+                    applyPlusTwoChange(&g);
+                    g.effectState = NO_EFFECT;
+                }
+                if (r.effectState != NO_EFFECT) {
+                    refApplyPlusTwoChange(&r);
+                    r.effectState = NO_EFFECT;
+                }
+                break;
+            case OP_RESCORE:
+                calculateScore(&g);
+                refCalculateScore(&r);
+                break;
+        }
+        if (op.kind == OP_SELECT || op.kind == OP_PLAY) (*moves)++;
+        if (gotResult != refResult) {
+            snprintf(why, whySize, "op returned %d != %d", gotResult, refResult);
+            return i;
+        }
+        if (!sameState(&g, &r, why, whySize)) return i;
+    }
+    return -1;
+}
+
+// ---- 縮小と再現手順 ----
+
+static bool caseFails(const FuzzCase* fc) {
+    long long moves = 0;
+    char why[128];
+    return runCase(fc, &moves, why, sizeof(why)) >= 0;
+}
+
+// 食い違った操作より後ろを捨ててから、塊ごとに取り除いても食い違いが残るなら取り除く
+static void shrinkCase(FuzzCase* fc, int failedAt) {
+    fc->ops.resize(failedAt + 1);
+    for (int chunk = (int)fc->ops.size() / 2; chunk >= 1; chunk /= 2) {
+        int start = 0;
+        while (start < (int)fc->ops.size()) {
+            FuzzCase candidate;
+            candidate.seed = fc->seed;
+            candidate.ops.assign(fc->ops.begin(), fc->ops.begin() + start);
+            int end = start + chunk < (int)fc->ops.size() ? start + chunk : (int)fc->ops.size();
+            candidate.ops.insert(candidate.ops.end(), fc->ops.begin() + end, fc->ops.end());
+            if (!candidate.ops.empty() && caseFails(&candidate)) {
+                fc->ops.swap(candidate.ops);
+            } else {
+                start += chunk;
+            }
+        }
+    }
+}
+
+// 再現手順の書式: "<seed>:<op>,<op>,..."（s列 = selectColumn、p列 = playMove、a = applyPlusTwoChange、r = calculateScore）
+static std::string formatCase(const FuzzCase* fc) {
+    std::string text = std::to_string((unsigned long long)fc->seed) + ":";
+    for (size_t i = 0; i < fc->ops.size(); i++) {
+        if (i > 0) text += ",";
+        const FuzzOp& op = fc->ops[i];
+        switch (op.kind) {
+            case OP_SELECT: text += "s" + std::to_string(op.col); break;
+            case OP_PLAY: text += "p" + std::to_string(op.col); break;
+            case OP_APPLY: text += "a"; break;
+            default: text += "r"; break;
+        }
+    }
+    return text;
+}
+
+static bool parseCase(const char* text, FuzzCase* fc) {
+    char* end;
+    fc->seed = strtoull(text, &end, 10);
+    if (*end != ':') return false;
+    fc->ops.clear();
+    const char* p = end + 1;
+    while (*p) {
+        FuzzOp op;
+        op.col = 0;
+        switch (*p++) {
+            case 's': op.kind = OP_SELECT; op.col = (int8_t)strtol(p, (char**)&p, 10); break;
+            case 'p': op.kind = OP_PLAY; op.col = (int8_t)strtol(p, (char**)&p, 10); break;
+            case 'a': op.kind = OP_APPLY; break;
+            case 'r': op.kind = OP_RESCORE; break;
+            default: return false;
+        }
+        fc->ops.push_back(op);
+        if (*p == ',') p++;
+        else if (*p) return false;
+    }
+    return !fc->ops.empty();
+}
+
+static void printUsage() {
+    printf("usage: puzzle_fuzz [--cases N] [--max-ops N] [--seed N] [--threads N] [--replay <repro>] [--mutate]\n");
+}
+
+int main(int argc, char** argv) {
+    int cases = 100000;
+    int maxOps = 200;
+    uint64_t seed = 1;
+    int threads = 0;
+    const char* replay = NULL;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--cases") == 0 && hasValue) {
+            cases = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-ops") == 0 && hasValue) {
+            maxOps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--replay") == 0 && hasValue) {
+            replay = argv[++i];
+        } else if (strcmp(argv[i], "--mutate") == 0) {
+            mutateReference = true;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (cases <= 0 || maxOps <= 0) {
+        printUsage();
+        return 2;
+    }
+
+    if (replay) {
+        FuzzCase fc;
+        if (!parseCase(replay, &fc)) {
+            fprintf(stderr, "再現手順の書式が不正です: %s\n", replay);
+            return 2;
+        }
+        long long moves = 0;
+        char why[128];
+        int failedAt = runCase(&fc, &moves, why, sizeof(why));
+        if (failedAt < 0) {
+            printf("ok: %zu ops\n", fc.ops.size());
+            return 0;
+        }
+        printf("mismatch at op %d: %s\n", failedAt, why);
+        return 1;
+    }
+
+    // 各ケースは番号から決まる。食い違いは番号の最も小さいケースを報告する
+    ThreadPool pool(threads);
+    std::vector<long long> movesPerWorker(pool.size(), 0);
+    std::atomic<int> firstFailure(cases);
+    auto startTime = std::chrono::steady_clock::now();
+    pool.parallelFor(cases, 64, [&](int begin, int end, int worker) {
+        FuzzCase fc;
+        char why[128];
+        for (int i = begin; i < end && i < firstFailure.load(std::memory_order_relaxed); i++) {
+            generateCase(seed + (uint64_t)i, maxOps, &fc);
+            if (runCase(&fc, &movesPerWorker[worker], why, sizeof(why)) >= 0) {
+                int current = firstFailure.load();
+                while (i < current && !firstFailure.compare_exchange_weak(current, i)) {}
+            }
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    long long moves = 0;
+    for (long long m : movesPerWorker) moves += m;
+
+    printf("%d cases, %lld moves in %.2fs (%.0f moves/s, %d threads)\n", cases, moves, seconds,
+           seconds > 0 ? moves / seconds : 0.0, pool.size());
+    if (firstFailure.load() >= cases) {
+        printf("no mismatches\n");
+        return 0;
+    }
+
+    FuzzCase fc;
+    generateCase(seed + (uint64_t)firstFailure.load(), maxOps, &fc);
+    long long ignored = 0;
+    char why[128];
+    int failedAt = runCase(&fc, &ignored, why, sizeof(why));
+    printf("mismatch in case %d at op %d of %zu: %s\n", firstFailure.load(), failedAt, fc.ops.size(), why);
+    shrinkCase(&fc, failedAt);
+    failedAt = runCase(&fc, &ignored, why, sizeof(why));
+    printf("shrunk to %zu ops (mismatch at op %d: %s)\n", fc.ops.size(), failedAt, why);
+    printf("repro: puzzle_fuzz --replay %s%s\n", formatCase(&fc).c_str(), mutateReference ? " --mutate" : "");
+    return 1;
+}
@@ -0,0 +1,149 @@
+// 序盤定跡の生成ツール
+//   puzzle_book --out opening_book.bin [--depth 3] [--games 100000 --plies 2] [--exhaustive] [--seed 1]
+//
+// --games/--plies（既定）: 乱数シードから対局を作り、先頭 plies 手までに現れた局面を探索する
+//                          赤・青どちらの手番の局面も入るので、両陣営の探索AIが使える（既定は 100000局）
+// --exhaustive: 初手（全列が EMPTY、赤の手番）の全局面を列の並び順を無視して列挙し、すべて探索する
+//               青は必ず塗られた列がある局面で打つので、これは赤の探索AI（--red search）にしか当たらない
+#include "opening_book.h"
+#include "search.h"
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#define BOOK_DEFAULT_GAMES 100000
+
+typedef struct {
+    const char* outPath;
+    int depth;
+    int games;
+    int plies;
+    bool exhaustive;
+    uint64_t seed;
+} BookOptions;
+
+static void printUsage() {
+    printf("usage: puzzle_book --out <file> [--depth N] [--games N] [--plies N] [--exhaustive] [--seed N]\n");
+    printf("  既定は対局サンプル（--games %d）。--exhaustive は赤の初手だけを列挙する\n", BOOK_DEFAULT_GAMES);
+}
+
+static bool parseOptions(int argc, char** argv, BookOptions* opt) {
+    opt->outPath = "opening_book.bin";
+    opt->depth = 3;
+    opt->games = 0;
+    opt->plies = 2;
+    opt->exhaustive = false;
+    opt->seed = 1;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--out") == 0 && hasValue) opt->outPath = argv[++i];
+        else if (strcmp(argv[i], "--depth") == 0 && hasValue) opt->depth = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--games") == 0 && hasValue) opt->games = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--plies") == 0 && hasValue) opt->plies = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) opt->seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--exhaustive") == 0) opt->exhaustive = true;
+        else return false;
+    }
+    // どちらも指定がなければ対局サンプルで作る
+    if (!opt->exhaustive && opt->games <= 0) opt->games = BOOK_DEFAULT_GAMES;
+    return true;
+}
+
+// 初手局面：再生成分類6つの重複組合せ（列の並びは区別しない）。どれも赤の手番
+static void enumerateFirstPlyPositions(std::vector<SearchPosition>* positions) {
+    const RerollClass* classes = getRerollClasses();
+    int c[BOARD_SIZE] = {0};
+    for (;;) {
+        SearchPosition pos;
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            pos.columns[col] = COLUMN_KEY(EMPTY, classes[c[col]].plusCount, 0, classes[c[col]].minusCount);
+        }
+        pos.redScore = 0;
+        pos.blueScore = 0;
+        pos.currentPlayer = PLAYER_RED;
+        pos.paintedColumns = 0;
+        pos.plusTwoTriggered = false;
+        pos.gameOver = false;
+        positions->push_back(pos);
+
+        // 非減少列の次の組合せへ
+        int i = BOARD_SIZE - 1;
+        while (i >= 0 && c[i] == REROLL_CLASS_COUNT - 1) i--;
+        if (i < 0) break;
+        c[i]++;
+        for (int j = i + 1; j < BOARD_SIZE; j++) c[j] = c[i];
+    }
+}
+
+// 対局を進めながら先頭の局面とその最善手を集める
+static void collectSampledEntries(const BookOptions* opt, std::vector<BookEntry>* entries) {
+    ThreadPool& pool = getSharedThreadPool();
+    std::vector<std::vector<BookEntry>> perWorker(pool.size());
+    pool.parallelFor(opt->games, 16, [&](int begin, int end, int worker) {
+        for (int i = begin; i < end; i++) {
+            GameState state;
+            seedGame(&state, opt->seed + (uint64_t)i);
+            resetGame(&state);
+            for (int ply = 0; ply < opt->plies && !state.gameOver; ply++) {
+                SearchPosition pos;
+                makeSearchPosition(&state, &pos);
+                uint16_t key = searchBestColumnKey(&pos, opt->depth);
+                perWorker[worker].push_back(BookEntry{canonicalPositionHash(&pos), key});
+                for (int col = 0; col < BOARD_SIZE; col++) {
+                    if (pos.columns[col] == key && isColumnSelectable(&state, col)) {
+                        playMove(&state, col);
+                        break;
+                    }
+                }
+            }
+        }
+    });
+    for (const std::vector<BookEntry>& part : perWorker) {
+        entries->insert(entries->end(), part.begin(), part.end());
+    }
+}
+
+int main(int argc, char** argv) {
+    BookOptions opt;
+    if (!parseOptions(argc, argv, &opt)) {
+        printUsage();
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    OpeningBook book;
+    book.depth = opt.depth;
+
+    if (opt.exhaustive) {
+        std::vector<SearchPosition> positions;
+        enumerateFirstPlyPositions(&positions);
+        printf("初手局面: %zu (depth %d)\n", positions.size(), opt.depth);
+        fflush(stdout);
+
+        size_t base = book.entries.size();
+        book.entries.resize(base + positions.size());
+        getSharedThreadPool().parallelFor((int)positions.size(), 64, [&](int begin, int end, int) {
+            for (int i = begin; i < end; i++) {
+                book.entries[base + i].hash = canonicalPositionHash(&positions[i]);
+                book.entries[base + i].columnKey = searchBestColumnKey(&positions[i], opt.depth);
+            }
+        });
+    }
+
+    if (opt.games > 0) {
+        printf("対局サンプル: %d局 x %d手 (depth %d)\n", opt.games, opt.plies, opt.depth);
+        fflush(stdout);
+        collectSampledEntries(&opt, &book.entries);
+    }
+
+    if (!saveOpeningBook(&book, opt.outPath)) {
+        fprintf(stderr, "定跡ファイルを書き込めません: %s\n", opt.outPath);
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    printf("%zu局面を書き出しました: %s (%.1f秒)\n", book.entries.size(), opt.outPath, seconds);
+    return 0;
+}
@@ -0,0 +1,241 @@
+// 探索用局面の全列挙（チェスの perft に倣ったルールの回帰確認と手生成・適用の速度測定）
+//   puzzle_perft [--seed 1] [--moves 0123] [--depth 3] [--unique] [--divide] [--threads 0]
+//
+// 1手 = 列の選択 + 再生成の分類（28通り）。最後の列を塗る手は再生成が勝敗に関係しないので1通りとし、
+// 終局した局面はそれ以上進めない。深さごとに手順の数（nodes）とそのうちの終局数（terminal）を数える
+// --unique は深さごとに局面を canonicalPositionHash でまとめ、異なる局面の数（unique）も数える
+// （同じ局面に至る手順の数を持ち回るので nodes は通常の列挙と一致する）
+// --divide は最初の列ごとに深さ d の手順数を表示する（通常の列挙のみ）
+#include "search.h"
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#define PERFT_MAX_DEPTH 8   // 手順数は深さ8で約6e17（uint64に収まる範囲）
+
+typedef struct {
+    uint64_t nodes[PERFT_MAX_DEPTH + 1];
+    uint64_t terminal[PERFT_MAX_DEPTH + 1];
+} PerftCounts;
+
+// 子局面を順に visit(列, 子局面) に渡す（終局する手は再生成1通り）
+template <typename Visit>
+static void forEachChild(const SearchPosition* pos, Visit visit) {
+    for (int col = 0; col < BOARD_SIZE; col++) {
+        SearchPosition moved = *pos;
+        if (!applySearchMove(&moved, col)) continue;
+        if (moved.paintedColumns >= BOARD_SIZE) {
+            applyRerollClass(&moved, col, 0);
+            visit(col, &moved);
+            continue;
+        }
+        for (int k = 0; k < REROLL_CLASS_COUNT; k++) {
+            SearchPosition child = moved;
+            applyRerollClass(&child, col, k);
+            visit(col, &child);
+        }
+    }
+}
+
+static void perft(const SearchPosition* pos, int depth, int maxDepth, PerftCounts* counts) {
+    forEachChild(pos, [&](int, const SearchPosition* child) {
+        counts->nodes[depth + 1]++;
+        if (child->gameOver) {
+            counts->terminal[depth + 1]++;
+        } else if (depth + 1 < maxDepth) {
+            perft(child, depth + 1, maxDepth, counts);
+        }
+    });
+}
+
+static void addCounts(PerftCounts* into, const PerftCounts* from) {
+    for (int d = 0; d <= PERFT_MAX_DEPTH; d++) {
+        into->nodes[d] += from->nodes[d];
+        into->terminal[d] += from->terminal[d];
+    }
+}
+
+// 深さ1の子局面をワーカーで分担して深さ優先に数える
+static void runPerft(const SearchPosition* root, int maxDepth, int threads, PerftCounts* total,
+                     uint64_t divide[BOARD_SIZE]) {
+    std::vector<SearchPosition> children;
+    std::vector<int> childColumns;
+    forEachChild(root, [&](int col, const SearchPosition* child) {
+        children.push_back(*child);
+        childColumns.push_back(col);
+    });
+
+    ThreadPool pool(threads);
+    std::vector<PerftCounts> childCounts(children.size());
+    memset(childCounts.data(), 0, childCounts.size() * sizeof(PerftCounts));
+    pool.parallelForStealing((int)children.size(), 1, [&](int begin, int end, int) {
+        for (int i = begin; i < end; i++) {
+            PerftCounts* counts = &childCounts[i];
+            counts->nodes[1] = 1;
+            if (children[i].gameOver) {
+                counts->terminal[1] = 1;
+            } else if (maxDepth > 1) {
+                perft(&children[i], 1, maxDepth, counts);
+            }
+        }
+    });
+
+    memset(total, 0, sizeof(*total));
+    total->nodes[0] = 1;
+    for (size_t i = 0; i < children.size(); i++) {
+        addCounts(total, &childCounts[i]);
+        divide[childColumns[i]] += childCounts[i].nodes[maxDepth];
+    }
+}
+
+// 深さごとに局面をまとめ、局面ごとの手順数を持ち回って幅優先に数える
+typedef struct {
+    SearchPosition pos;
+    uint64_t hash;
+    uint64_t paths;
+} LayerEntry;
+
+// 1層分の局面表（開番地法。slots には entries の添字 + 1 を入れ、0 は空き）
+typedef struct {
+    std::vector<LayerEntry> entries;
+    std::vector<uint32_t> slots;
+} PositionLayer;
+
+static void growLayer(PositionLayer* layer) {
+    size_t capacity = layer->slots.empty() ? 1024 : layer->slots.size() * 2;
+    layer->slots.assign(capacity, 0);
+    for (size_t i = 0; i < layer->entries.size(); i++) {
+        size_t slot = layer->entries[i].hash & (capacity - 1);
+        while (layer->slots[slot] != 0) slot = (slot + 1) & (capacity - 1);
+        layer->slots[slot] = (uint32_t)(i + 1);
+    }
+}
+
+static void addToLayer(PositionLayer* layer, const SearchPosition* pos, uint64_t paths) {
+    if ((layer->entries.size() + 1) * 2 > layer->slots.size()) growLayer(layer);
+    uint64_t hash = canonicalPositionHash(pos);
+    size_t mask = layer->slots.size() - 1;
+    size_t slot = hash & mask;
+    while (layer->slots[slot] != 0) {
+        LayerEntry* entry = &layer->entries[layer->slots[slot] - 1];
+        if (entry->hash == hash) {
+            entry->paths += paths;
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+    layer->slots[slot] = (uint32_t)(layer->entries.size() + 1);
+    layer->entries.push_back(LayerEntry{*pos, hash, paths});
+}
+
+static void runUniquePerft(const SearchPosition* root, int maxDepth, PerftCounts* total,
+                           uint64_t unique[PERFT_MAX_DEPTH + 1]) {
+    memset(total, 0, sizeof(*total));
+    total->nodes[0] = 1;
+    unique[0] = 1;
+
+    PositionLayer layer;
+    addToLayer(&layer, root, 1);
+    for (int depth = 0; depth < maxDepth; depth++) {
+        PositionLayer next;
+        for (const LayerEntry& entry : layer.entries) {
+            if (entry.pos.gameOver) continue;
+            forEachChild(&entry.pos, [&](int, const SearchPosition* child) {
+                total->nodes[depth + 1] += entry.paths;
+                if (child->gameOver) total->terminal[depth + 1] += entry.paths;
+                addToLayer(&next, child, entry.paths);
+            });
+        }
+        unique[depth + 1] = next.entries.size();
+        std::swap(layer, next);
+    }
+}
+
+static void printUsage() {
+    printf("usage: puzzle_perft [--seed N] [--moves 0123] [--depth D] [--unique] [--divide] [--threads N]\n");
+}
+
+int main(int argc, char** argv) {
+    uint64_t seed = 1;
+    const char* moves = "";
+    int depth = 3;
+    bool uniqueMode = false;
+    bool divideMode = false;
+    int threads = 0;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--moves") == 0 && hasValue) {
+            moves = argv[++i];
+        } else if (strcmp(argv[i], "--depth") == 0 && hasValue) {
+            depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--unique") == 0) {
+            uniqueMode = true;
+        } else if (strcmp(argv[i], "--divide") == 0) {
+            divideMode = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (depth < 1 || depth > PERFT_MAX_DEPTH) {
+        fprintf(stderr, "深さは 1〜%d で指定してください\n", PERFT_MAX_DEPTH);
+        return 1;
+    }
+
+    // 開始局面: シードの初期盤面から --moves の列順に進める
+    GameState state;
+    memset(&state, 0, sizeof(state));
+    seedGame(&state, seed);
+    resetGame(&state);
+    for (const char* p = moves; *p; p++) {
+        if (*p < '0' || *p > '5' || !playMove(&state, *p - '0')) {
+            fprintf(stderr, "打てない手です: %c\n", *p);
+            return 1;
+        }
+    }
+    SearchPosition root;
+    makeSearchPosition(&state, &root);
+    printf("root %016llx (seed %llu, moves \"%s\"), depth %d%s\n", (unsigned long long)canonicalPositionHash(&root),
+           (unsigned long long)seed, moves, depth, uniqueMode ? ", unique" : "");
+
+    PerftCounts counts;
+    uint64_t divide[BOARD_SIZE] = {0};
+    uint64_t unique[PERFT_MAX_DEPTH + 1] = {0};
+    auto startTime = std::chrono::steady_clock::now();
+    if (uniqueMode) {
+        runUniquePerft(&root, depth, &counts, unique);
+    } else {
+        runPerft(&root, depth, threads, &counts, divide);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    uint64_t totalNodes = 0;
+    printf("%5s %20s %16s", "depth", "nodes", "terminal");
+    if (uniqueMode) printf(" %14s", "unique");
+    printf("\n");
+    for (int d = 0; d <= depth; d++) {
+        totalNodes += counts.nodes[d];
+        printf("%5d %20llu %16llu", d, (unsigned long long)counts.nodes[d], (unsigned long long)counts.terminal[d]);
+        if (uniqueMode) printf(" %14llu", (unsigned long long)unique[d]);
+        printf("\n");
+    }
+    if (divideMode && !uniqueMode) {
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            if (divide[col] > 0) printf("column %d: %llu\n", col, (unsigned long long)divide[col]);
+        }
+    }
+    // --unique の nodes は手順数を掛け合わせた値なので、実際に展開した局面数の速度にはならない
+    if (uniqueMode) {
+        printf("%.3fs\n", seconds);
+    } else {
+        printf("%.3fs, %.1f Mnodes/s\n", seconds, seconds > 0 ? totalNodes / seconds / 1e6 : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,204 @@
+// 棋譜データベースの作成と検索
+//   puzzle_replaydb build <games.pzgr> <games.pzdb> [--threads 0]
+//   puzzle_replaydb query <games.pzdb> (--hash H | --seed S [--moves 0123]) [--list 10]
+//   puzzle_replaydb bench <games.pzdb> [--queries 1000000]
+//
+// query は局面が現れた対局数・結果の内訳・その局面で選ばれた列ごとの勝率を表示する
+// 局面はハッシュで直接指定するか、シードからの対局を --moves の列順に進めて指定する
+#include "replay_db.h"
+#include "search.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+static void printUsage() {
+    printf("usage: puzzle_replaydb build <records> <database> [--threads N]\n");
+    printf("       puzzle_replaydb query <database> (--hash H | --seed S [--moves 0123]) [--list N]\n");
+    printf("       puzzle_replaydb bench <database> [--queries N]\n");
+}
+
+static int runBuild(int argc, char** argv) {
+    if (argc < 4) {
+        printUsage();
+        return 1;
+    }
+    int threads = 0;
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    if (!buildReplayDatabase(argv[2], argv[3], threads)) {
+        fprintf(stderr, "データベースを作成できません: %s\n", argv[3]);
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    ReplayDatabase db;
+    if (!openReplayDatabase(&db, argv[3])) return 1;
+    printf("%llu games, %llu positions, %llu postings, %zu bytes (%.2fs)\n",
+           (unsigned long long)db.header->gameCount, (unsigned long long)db.header->positionCount,
+           (unsigned long long)db.header->postingCount, db.file.size, seconds);
+    closeReplayDatabase(&db);
+    return 0;
+}
+
+static int runQuery(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+    bool hasHash = false, hasSeed = false;
+    uint64_t hash = 0, seed = 0;
+    const char* moves = "";
+    int list = 10;
+    for (int i = 3; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--hash") == 0 && hasValue) {
+            hash = strtoull(argv[++i], NULL, 0);
+            hasHash = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = strtoull(argv[++i], NULL, 10);
+            hasSeed = true;
+        } else if (strcmp(argv[i], "--moves") == 0 && hasValue) {
+            moves = argv[++i];
+        } else if (strcmp(argv[i], "--list") == 0 && hasValue) {
+            list = atoi(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (hasHash == hasSeed) {
+        printUsage();
+        return 1;
+    }
+
+    if (hasSeed) {
+        GameState state;
+        memset(&state, 0, sizeof(state));
+        seedGame(&state, seed);
+        resetGame(&state);
+        for (const char* p = moves; *p; p++) {
+            if (*p < '0' || *p > '5' || !playMove(&state, *p - '0')) {
+                fprintf(stderr, "打てない手です: %c\n", *p);
+                return 1;
+            }
+        }
+        SearchPosition pos;
+        makeSearchPosition(&state, &pos);
+        hash = canonicalPositionHash(&pos);
+    }
+
+    ReplayDatabase db;
+    if (!openReplayDatabase(&db, argv[2])) {
+        fprintf(stderr, "データベースを開けません: %s\n", argv[2]);
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    const ReplayPosting* postings;
+    uint64_t count = findReplayPositions(&db, hash, &postings);
+
+    // 結果の内訳と、その局面で選ばれた列ごとの赤勝ち数
+    long long wins[3] = {0, 0, 0};   // PLAYER_TIE, PLAYER_RED, PLAYER_BLUE
+    long long columnGames[BOARD_SIZE] = {0}, columnRedWins[BOARD_SIZE] = {0};
+    long long finals = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        const ReplayGame& game = db.games[postings[i].game];
+        wins[game.winner]++;
+        int col = postings[i].column;
+        if (col == REPLAY_DB_FINAL_MOVE) {
+            finals++;
+        } else if (col < BOARD_SIZE) {
+            columnGames[col]++;
+            if (game.winner == PLAYER_RED) columnRedWins[col]++;
+        }
+    }
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+
+    printf("position %016llx: %llu occurrences (%.1f us)\n", (unsigned long long)hash, (unsigned long long)count, micros);
+    if (count > 0) {
+        printf("red wins %lld / blue wins %lld / ties %lld, final position %lld\n",
+               wins[PLAYER_RED], wins[PLAYER_BLUE], wins[PLAYER_TIE], finals);
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            if (columnGames[col] == 0) continue;
+            printf("  column %d: %lld games, red wins %.1f%%\n", col, columnGames[col],
+                   100.0 * columnRedWins[col] / columnGames[col]);
+        }
+        for (uint64_t i = 0; i < count && (int)i < list; i++) {
+            const ReplayGame& game = db.games[postings[i].game];
+            printf("  game %u ply %u: %d-%d in %u plies%s\n", postings[i].game, postings[i].ply,
+                   game.redScore, game.blueScore, game.plies, game.truncated ? " (truncated)" : "");
+        }
+    }
+    closeReplayDatabase(&db);
+    return 0;
+}
+
+// 登録済みの局面と存在しない局面を交互に引いて検索時間を測る
+static int runBench(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+    int queries = 1000000;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+            queries = atoi(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    ReplayDatabase db;
+    if (!openReplayDatabase(&db, argv[2])) {
+        fprintf(stderr, "データベースを開けません: %s\n", argv[2]);
+        return 1;
+    }
+    uint64_t positions = db.header->positionCount;
+    if (positions == 0 || queries <= 0) {
+        closeReplayDatabase(&db);
+        return 0;
+    }
+
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    uint64_t found = 0, occurrences = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < queries; i++) {
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        uint64_t hash = (i & 1) ? x : db.hashes[x % positions];
+        const ReplayPosting* postings;
+        uint64_t count = findReplayPositions(&db, hash, &postings);
+        if (count > 0) {
+            found++;
+            occurrences += db.games[postings[0].game].plies;  // 対局表も引いてみる
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    printf("%d queries (%llu found) in %.3fs: %.3f us/query (checksum %llu)\n", queries,
+           (unsigned long long)found, seconds, 1e6 * seconds / queries, (unsigned long long)occurrences);
+    closeReplayDatabase(&db);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    if (strcmp(argv[1], "build") == 0) return runBuild(argc, argv);
+    if (strcmp(argv[1], "query") == 0) return runQuery(argc, argv);
+    if (strcmp(argv[1], "bench") == 0) return runBench(argc, argv);
+    printUsage();
+    return 1;
+}
@@ -0,0 +1,192 @@
+// AI変更の逐次確率比検定（SPRT）
+//   puzzle_sprt --candidate search:3 --baseline search:2 [--elo0 0] [--elo1 10]
+//               [--alpha 0.05] [--beta 0.05] [--max-pairs 200000] [--seed 1] [--threads 0]
+//
+// 同じシードで候補を赤・青の両方で1局ずつ打つ2局を1組とし、組の得点（0, 0.5, 1, 1.5, 2）の
+// 五項分布から一般化SPRTの対数尤度比を組ごとに更新して、H0/H1 の境界を越えたところで止める
+// 終了コード: 0 = 合格（H1 採択）、1 = 不合格（H0 採択）、2 = 上限までに決着せず、3 = 引数エラー
+#include "match.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+typedef struct {
+    Controller candidate;
+    Controller baseline;
+    double elo0;
+    double elo1;
+    double alpha;
+    double beta;
+    int maxPairs;
+    uint64_t seed;
+    int threads;
+} SprtOptions;
+
+// 組の得点ごとの件数（候補の得点 0, 0.5, 1, 1.5, 2）
+typedef struct {
+    long long counts[5];
+    long long pairs;
+} Pentanomial;
+
+static void printUsage() {
+    printf("usage: puzzle_sprt --candidate <controller> --baseline <controller> [--elo0 E] [--elo1 E]\n");
+    printf("                   [--alpha A] [--beta B] [--max-pairs N] [--seed N] [--threads N]\n");
+}
+
+static bool parseOptions(int argc, char** argv, SprtOptions* opt) {
+    memset(opt, 0, sizeof(*opt));
+    opt->elo0 = 0.0;
+    opt->elo1 = 10.0;
+    opt->alpha = 0.05;
+    opt->beta = 0.05;
+    opt->maxPairs = 200000;
+    opt->seed = 1;
+    bool hasCandidate = false, hasBaseline = false;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--candidate") == 0 && hasValue) {
+            hasCandidate = parseController(argv[++i], &opt->candidate);
+        } else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            hasBaseline = parseController(argv[++i], &opt->baseline);
+        } else if (strcmp(argv[i], "--elo0") == 0 && hasValue) {
+            opt->elo0 = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--elo1") == 0 && hasValue) {
+            opt->elo1 = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--alpha") == 0 && hasValue) {
+            opt->alpha = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--beta") == 0 && hasValue) {
+            opt->beta = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-pairs") == 0 && hasValue) {
+            opt->maxPairs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            opt->seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            opt->threads = atoi(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return hasCandidate && hasBaseline &&
+           opt->candidate.kind != CONTROLLER_HUMAN && opt->baseline.kind != CONTROLLER_HUMAN &&
+           opt->elo1 > opt->elo0 && opt->alpha > 0 && opt->alpha < 1 && opt->beta > 0 && opt->beta < 1 &&
+           opt->maxPairs > 0;
+}
+
+static double scoreFromElo(double elo) {
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+static double eloFromScore(double score) {
+    if (score <= 0.0) score = 1e-6;
+    if (score >= 1.0) score = 1.0 - 1e-6;
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+// 組の得点を [0,1] に正規化した平均と分散
+static void pentanomialMoments(const Pentanomial* p, double* mean, double* variance) {
+    *mean = 0.0;
+    *variance = 0.0;
+    if (p->pairs == 0) return;
+    for (int k = 0; k < 5; k++) *mean += p->counts[k] * (k / 4.0);
+    *mean /= p->pairs;
+    for (int k = 0; k < 5; k++) {
+        double d = k / 4.0 - *mean;
+        *variance += p->counts[k] * d * d;
+    }
+    *variance /= p->pairs;
+}
+
+// 一般化SPRTの正規近似: LLR = N (s1 - s0)(2μ - s0 - s1) / (2σ²)
+static double computeLLR(const Pentanomial* p, double s0, double s1) {
+    double mean, variance;
+    pentanomialMoments(p, &mean, &variance);
+    if (variance < 1e-12) return 0.0;  // まだ結果にばらつきがない
+    return p->pairs * (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance);
+}
+
+// 1組（同じシードで候補が赤・青を1局ずつ）を打ち、候補の得点を 0..4（0.5点単位）で返す
+static int playPair(const SprtOptions* opt, uint64_t seed) {
+    int halfPoints = 0;
+    MatchResult result;
+    playMatch(&opt->candidate, &opt->baseline, seed, &result);
+    halfPoints += result.winner == PLAYER_RED ? 2 : (result.winner == PLAYER_TIE ? 1 : 0);
+    playMatch(&opt->baseline, &opt->candidate, seed, &result);
+    halfPoints += result.winner == PLAYER_BLUE ? 2 : (result.winner == PLAYER_TIE ? 1 : 0);
+    return halfPoints;
+}
+
+int main(int argc, char** argv) {
+    SprtOptions opt;
+    if (!parseOptions(argc, argv, &opt)) {
+        printUsage();
+        return 3;
+    }
+
+    char candidateName[32], baselineName[32];
+    formatController(&opt.candidate, candidateName, sizeof(candidateName));
+    formatController(&opt.baseline, baselineName, sizeof(baselineName));
+
+    double s0 = scoreFromElo(opt.elo0);
+    double s1 = scoreFromElo(opt.elo1);
+    double lowerBound = log(opt.beta / (1.0 - opt.alpha));
+    double upperBound = log((1.0 - opt.beta) / opt.alpha);
+
+    ThreadPool pool(opt.threads);
+    printf("SPRT %s vs %s: elo0=%.1f elo1=%.1f alpha=%.3f beta=%.3f bounds=[%.3f, %.3f], %d threads\n",
+           candidateName, baselineName, opt.elo0, opt.elo1, opt.alpha, opt.beta, lowerBound, upperBound, pool.size());
+    fflush(stdout);
+
+    // 組はまとめて並列に打つが、LLR は組の番号順に1組ずつ更新し、境界を越えた組で打ち切る
+    // （その後ろの組の結果は捨てる）ので、スレッド数によらず同じ判定になる
+    int batchSize = pool.size() * 64;
+    std::vector<int> batch(batchSize);
+    Pentanomial penta;
+    memset(&penta, 0, sizeof(penta));
+    double llr = 0.0;
+    int verdict = 2;
+    auto startTime = std::chrono::steady_clock::now();
+    long long nextReport = 1000;
+
+    for (int first = 0; first < opt.maxPairs && verdict == 2; first += batchSize) {
+        int count = opt.maxPairs - first < batchSize ? opt.maxPairs - first : batchSize;
+        pool.parallelForStealing(count, 1, [&](int begin, int end, int) {
+            for (int i = begin; i < end; i++) {
+                batch[i] = playPair(&opt, opt.seed + (uint64_t)(first + i));
+            }
+        });
+
+        for (int i = 0; i < count; i++) {
+            penta.counts[batch[i]]++;
+            penta.pairs++;
+            llr = computeLLR(&penta, s0, s1);
+            if (llr >= upperBound) { verdict = 0; break; }
+            if (llr <= lowerBound) { verdict = 1; break; }
+        }
+
+        if (penta.pairs >= nextReport) {
+            printf("  %lld pairs, LLR %.3f\n", penta.pairs, llr);
+            fflush(stdout);
+            while (nextReport <= penta.pairs) nextReport *= 2;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    double mean, variance;
+    pentanomialMoments(&penta, &mean, &variance);
+    double margin = penta.pairs > 0 ? 1.96 * sqrt(variance / penta.pairs) : 0.0;
+
+    printf("pairs: %lld (%lld games, %.2fs)\n", penta.pairs, penta.pairs * 2, seconds);
+    printf("pentanomial [0, 0.5, 1, 1.5, 2]: %lld %lld %lld %lld %lld\n",
+           penta.counts[0], penta.counts[1], penta.counts[2], penta.counts[3], penta.counts[4]);
+    printf("score: %.2f%%, elo: %.1f [%.1f, %.1f]\n", 100.0 * mean, eloFromScore(mean),
+           eloFromScore(mean - margin), eloFromScore(mean + margin));
+    printf("LLR: %.3f [%.3f, %.3f]\n", llr, lowerBound, upperBound);
+    if (verdict == 0) printf("RESULT: PASS (H1 accepted)\n");
+    else if (verdict == 1) printf("RESULT: FAIL (H0 accepted)\n");
+    else printf("RESULT: INCONCLUSIVE (max pairs reached)\n");
+    return verdict;
+}
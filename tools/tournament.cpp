@@ -0,0 +1,247 @@
+// AI同士の自己対戦トーナメント
+//   puzzle_tournament --players greedy,search:2,random [--mode roundrobin|gauntlet]
+//                     [--pairs 1000] [--seed 1] [--threads 0] [--record games.pzgr]
+//
+// 組み合わせごとに同じシードで先手・後手を入れ替えた2局を1組として対局し、先手有利を打ち消す
+// 対局の長さは再生成次第でばらつくので、組の割り当てはワークスティーリングで行う
+#include "match.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#define MAX_PLAYERS 16
+
+typedef struct {
+    Controller players[MAX_PLAYERS];
+    char names[MAX_PLAYERS][32];
+    int playerCount;
+    bool gauntlet;       // 先頭のプレイヤー対その他全員
+    int pairs;           // 組み合わせごとの対局組数（1組 = 2局）
+    uint64_t seed;
+    int threads;         // 0 = ハードウェアスレッド数
+    const char* recordPath;  // 棋譜の出力先（NULL = 記録しない）
+} TournamentOptions;
+
+// 組み合わせ1つ分の集計（a 視点）
+typedef struct {
+    long long wins;
+    long long draws;
+    long long losses;
+    long long plies;
+    double marginSum;        // a のスコア - b のスコア
+    double marginSquareSum;
+} PairingStats;
+
+typedef struct {
+    int a;
+    int b;
+} Pairing;
+
+static void printUsage() {
+    printf("usage: puzzle_tournament --players <c1,c2,...> [--mode roundrobin|gauntlet] [--pairs N] [--seed N] [--threads N]\n");
+    printf("                         [--record <file>]\n");
+    printf("  controller: greedy | search[:depth] | random | script:c0,c1,...\n");
+}
+
+// カンマ区切りのプレイヤー一覧。script:0,1,2 のように数字が続くカンマはスクリプトの一部とみなす
+static bool parsePlayers(const char* list, TournamentOptions* opt) {
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer), "%s", list);
+    opt->playerCount = 0;
+    char* start = buffer;
+    while (*start) {
+        char* end = strchr(start, ',');
+        if (strncmp(start, "script:", 7) == 0) {
+            while (end && end[1] >= '0' && end[1] <= '9') end = strchr(end + 1, ',');
+        }
+        if (end) *end = '\0';
+
+        if (opt->playerCount >= MAX_PLAYERS) return false;
+        Controller* c = &opt->players[opt->playerCount];
+        if (!parseController(start, c) || c->kind == CONTROLLER_HUMAN) return false;
+        formatController(c, opt->names[opt->playerCount], sizeof(opt->names[0]));
+        opt->playerCount++;
+        start = end ? end + 1 : start + strlen(start);
+    }
+    return opt->playerCount >= 2;
+}
+
+static bool parseOptions(int argc, char** argv, TournamentOptions* opt) {
+    memset(opt, 0, sizeof(*opt));
+    opt->pairs = 1000;
+    opt->seed = 1;
+    bool hasPlayers = false;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--players") == 0 && hasValue) {
+            if (!parsePlayers(argv[++i], opt)) return false;
+            hasPlayers = true;
+        } else if (strcmp(argv[i], "--mode") == 0 && hasValue) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "gauntlet") == 0) opt->gauntlet = true;
+            else if (strcmp(mode, "roundrobin") != 0) return false;
+        } else if (strcmp(argv[i], "--pairs") == 0 && hasValue) {
+            opt->pairs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            opt->seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            opt->threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && hasValue) {
+            opt->recordPath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return hasPlayers && opt->pairs > 0;
+}
+
+// 対局組ごとのシード。どのスレッドが担当しても同じ対局になる
+static uint64_t pairSeed(uint64_t base, int pairing, int pair) {
+    uint64_t x = base ^ ((uint64_t)pairing << 40) ^ (uint64_t)pair;
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static void addGame(PairingStats* stats, const MatchResult* result, bool aIsRed) {
+    int aScore = aIsRed ? result->redScore : result->blueScore;
+    int bScore = aIsRed ? result->blueScore : result->redScore;
+    if (aScore > bScore) stats->wins++;
+    else if (aScore < bScore) stats->losses++;
+    else stats->draws++;
+    double margin = aScore - bScore;
+    stats->marginSum += margin;
+    stats->marginSquareSum += margin * margin;
+    stats->plies += result->plies;
+}
+
+// 得点率からのElo差（得点率が0か1ならNaN扱いで表示しない）
+static double eloFromScore(double score) {
+    if (score <= 0.0 || score >= 1.0) return NAN;
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+int main(int argc, char** argv) {
+    TournamentOptions opt;
+    if (!parseOptions(argc, argv, &opt)) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<Pairing> pairings;
+    for (int a = 0; a < opt.playerCount; a++) {
+        for (int b = a + 1; b < opt.playerCount; b++) {
+            if (opt.gauntlet && a != 0) continue;
+            pairings.push_back(Pairing{a, b});
+        }
+    }
+
+    ThreadPool pool(opt.threads);
+    int pairingCount = (int)pairings.size();
+    long long taskCount = (long long)pairingCount * opt.pairs;
+    if (taskCount > 0x7fffffff) {
+        fprintf(stderr, "対局組が多すぎます（最大 %d 組）\n", 0x7fffffff);
+        return 1;
+    }
+
+    printf("%s: %d players, %d pairings x %d pairs (%lld games), %d threads\n",
+           opt.gauntlet ? "gauntlet" : "round robin", opt.playerCount, pairingCount, opt.pairs,
+           taskCount * 2, pool.size());
+    fflush(stdout);
+
+    // 棋譜は完了した順にブロックへまとめて書く（局の順番はスレッド次第）
+    static GameRecordWriter recordWriter;
+    if (opt.recordPath && !openGameRecordWriter(&recordWriter, opt.recordPath)) {
+        fprintf(stderr, "棋譜ファイルを開けません: %s\n", opt.recordPath);
+        return 1;
+    }
+    GameRecordWriter* writer = opt.recordPath ? &recordWriter : NULL;
+
+    // ワーカーごと・組み合わせごとの集計を最後にまとめる
+    std::vector<PairingStats> perWorker((size_t)pool.size() * pairingCount);
+    memset(perWorker.data(), 0, perWorker.size() * sizeof(PairingStats));
+
+    auto startTime = std::chrono::steady_clock::now();
+    pool.parallelForStealing((int)taskCount, 4, [&](int begin, int end, int worker) {
+        GameRecord record;
+        GameRecord* recordOut = writer ? &record : NULL;
+        for (int task = begin; task < end; task++) {
+            int pairing = task % pairingCount;
+            int pair = task / pairingCount;
+            const Controller* a = &opt.players[pairings[pairing].a];
+            const Controller* b = &opt.players[pairings[pairing].b];
+            uint64_t seed = pairSeed(opt.seed, pairing, pair);
+            PairingStats* stats = &perWorker[(size_t)worker * pairingCount + pairing];
+
+            // 同じ盤面で先手・後手を入れ替えて2局
+            MatchResult result;
+            playMatch(a, b, seed, &result, recordOut);
+            if (writer) writeGameRecord(writer, &record);
+            addGame(stats, &result, true);
+            playMatch(b, a, seed, &result, recordOut);
+            if (writer) writeGameRecord(writer, &record);
+            addGame(stats, &result, false);
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::vector<PairingStats> totals(pairingCount);
+    memset(totals.data(), 0, totals.size() * sizeof(PairingStats));
+    for (int w = 0; w < pool.size(); w++) {
+        for (int p = 0; p < pairingCount; p++) {
+            const PairingStats& s = perWorker[(size_t)w * pairingCount + p];
+            totals[p].wins += s.wins;
+            totals[p].draws += s.draws;
+            totals[p].losses += s.losses;
+            totals[p].plies += s.plies;
+            totals[p].marginSum += s.marginSum;
+            totals[p].marginSquareSum += s.marginSquareSum;
+        }
+    }
+
+    // 組み合わせごとの結果（左側のプレイヤー視点）
+    printf("\n%-12s %-12s %8s %8s %8s %7s %8s %12s %9s\n",
+           "player", "opponent", "win", "draw", "loss", "score", "elo", "margin", "plies");
+    std::vector<double> points(opt.playerCount, 0.0);
+    std::vector<long long> played(opt.playerCount, 0);
+    long long totalGames = 0;
+    for (int p = 0; p < pairingCount; p++) {
+        const PairingStats& s = totals[p];
+        long long games = s.wins + s.draws + s.losses;
+        double score = games ? (s.wins + 0.5 * s.draws) / games : 0.0;
+        double mean = games ? s.marginSum / games : 0.0;
+        double variance = games > 1 ? (s.marginSquareSum - games * mean * mean) / (games - 1) : 0.0;
+        printf("%-12s %-12s %8lld %8lld %8lld %6.1f%% %8.1f %6.2f±%-5.2f %9.1f\n",
+               opt.names[pairings[p].a], opt.names[pairings[p].b], s.wins, s.draws, s.losses,
+               100.0 * score, eloFromScore(score), mean, variance > 0 ? sqrt(variance) : 0.0,
+               games ? (double)s.plies / games : 0.0);
+        points[pairings[p].a] += s.wins + 0.5 * s.draws;
+        points[pairings[p].b] += s.losses + 0.5 * s.draws;
+        played[pairings[p].a] += games;
+        played[pairings[p].b] += games;
+        totalGames += games;
+    }
+
+    printf("\n%-12s %10s %7s\n", "player", "games", "score");
+    for (int i = 0; i < opt.playerCount; i++) {
+        if (played[i] == 0) continue;
+        printf("%-12s %10lld %6.1f%%\n", opt.names[i], played[i], 100.0 * points[i] / played[i]);
+    }
+
+    printf("\n%lld games in %.2fs (%.0f games/s)\n", totalGames, seconds, seconds > 0 ? totalGames / seconds : 0.0);
+    if (writer) {
+        if (!closeGameRecordWriter(writer)) {
+            fprintf(stderr, "棋譜ファイルの書き込みに失敗しました: %s\n", opt.recordPath);
+            return 1;
+        }
+        printf("recorded %llu games to %s (%llu bytes, %.1f bytes/game)\n",
+               (unsigned long long)writer->records, opt.recordPath, (unsigned long long)writer->bytes,
+               writer->records ? (double)writer->bytes / writer->records : 0.0);
+    }
+    return 0;
+}